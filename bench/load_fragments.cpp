@@ -0,0 +1,121 @@
+///	Loading many configuration fragments: each file read by a sequential std::ifstream, then the
+///	text parsed, against parse() with '--load' listing all of them, read in a single batch. Parsing
+///	the same text already in memory is timed too, the reads cost the difference.
+///	Build it twice to time both backends of the batch, io_uring and the pool of pread threads:
+///
+///		g++ -std=c++20 -O2 -o load_fragments bench/load_fragments.cpp
+///		g++ -std=c++20 -O2 -DOPTPARSE_NO_IO_URING -o load_fragments_pread bench/load_fragments.cpp
+///
+///		./load_fragments [directory] [files] [options per file] [repetitions]
+///
+///	The fragments are written to directory (/tmp/optparse_fragments by default), which can sit on
+///	the storage to be measured. The times are the best and the median of the repetitions, with
+///	the files in the page cache.
+
+#include "../optparse.hpp"
+
+#include <chrono>
+#include <filesystem>
+
+int main(int argc, char* argv[])
+{
+	auto const directory = std::filesystem::path(argc > 1 ? argv[1] : "/tmp/optparse_fragments");
+	auto const files = argc > 2 ? std::stoul(argv[2]) : 100ul;
+	auto const options = argc > 3 ? std::stoul(argv[3]) : 40ul;
+	auto const repetitions = argc > 4 ? std::stoul(argv[4]) : 200ul;
+
+	std::filesystem::create_directories(directory);
+
+	auto schema = optparse();
+	auto paths = std::vector<std::string> {};
+
+	for (size_t i = 0; i < files; ++i)
+	{
+		paths.push_back((directory / ("fragment_" + std::to_string(i) + ".txt")).string());
+
+		auto fragment = std::ofstream(paths.back());
+
+		for (size_t j = 0; j < options; ++j)
+		{
+			auto const name = "option_" + std::to_string(i) + "_" + std::to_string(j);
+
+			schema.insert_option(name, 2, "", "0, 0");
+			fragment << name << ": " << 0.5 * j << ", " << j << '\n';
+		}
+	}
+
+	auto const time = [repetitions](auto&& run)
+	{
+		auto samples = std::vector<double> {};
+
+		for (size_t r = 0; r < repetitions; ++r)
+		{
+			auto const start = std::chrono::steady_clock::now();
+
+			if (run() != 0)
+				throw std::runtime_error("parsing the fragments failed");
+
+			samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+		}
+		std::sort(samples.begin(), samples.end());
+
+		return std::pair(samples.front(), samples[samples.size() / 2]);
+	};
+
+	char program[] = "load_fragments";
+	char load[] = "--load";
+
+	auto joined = std::string {};
+
+	for (auto const& path: paths)
+		joined += (joined.empty() ? "" : ",") + path;
+
+	char* const command_line[] = { program, load, joined.data(), nullptr };
+
+	auto preloaded = std::string {};
+
+	for (auto const& path: paths)
+	{
+		auto file = std::ifstream(path);
+
+		preloaded.append(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	auto const in_memory = time([&]()
+	{
+		auto opts = schema;
+		return opts.parse(1, command_line, optparse::config_source::buffer(preloaded));
+	});
+
+	auto const sequential = time([&]()
+	{
+		auto text = std::string {};
+
+		for (auto const& path: paths)
+		{
+			auto file = std::ifstream(path);
+
+			text.append(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		}
+
+		auto opts = schema;
+		return opts.parse(1, command_line, optparse::config_source::buffer(text));
+	});
+
+	auto const batched = time([&]()
+	{
+		auto opts = schema;
+		return opts.parse(3, command_line);
+	});
+
+#ifdef OPTPARSE_IO_URING
+	auto const backend = "io_uring (pread pool if unavailable)";
+#else
+	auto const backend = "pread pool";
+#endif
+
+	std::cout << files << " files of " << options << " options, best / median of " << repetitions << " runs\n"
+		<< "  parse of the text already in memory: " << in_memory.first << " / " << in_memory.second << " us\n"
+		<< "  sequential ifstream, then parse: " << sequential.first << " / " << sequential.second << " us\n"
+		<< "  parse --load, " << backend << ": " << batched.first << " / " << batched.second << " us\n";
+}
@@ -3,334 +3,4447 @@
 
 #include <ctime>
 #include <cassert>
+#include <cctype>
 #include <cstring>
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <iomanip>
+#include <iterator>
 #include <fstream>
 #include <sstream>
 #include <map>
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <new>
+#include <cstddef>
+#include <type_traits>
+#include <array>
+#include <optional>
+#include <memory>
+#include <span>
+#include <vector>
+#include <iostream>
+#include <typeinfo>
 #include <algorithm>
+#include <bit>
+#include <thread>
+#include <utility>
+#include <coroutine>
+#include <condition_variable>
+#include <exception>
+#include <charconv>
+#include <cmath>
+#include <variant>
+#include <filesystem>
+
+#if __has_include(<unistd.h>) && __has_include(<sys/mman.h>)
+#define OPTPARSE_POSIX
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(OPTPARSE_POSIX) && __has_include(<sys/un.h>)
+#define OPTPARSE_UNIX_SOCKETS
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#if defined(OPTPARSE_POSIX) && __has_include(<linux/io_uring.h>) && !defined(OPTPARSE_NO_IO_URING)
+#include <linux/io_uring.h>
+#if defined(IORING_FEAT_RW_CUR_POS)	// Linux 5.6 headers, the first with openat, statx and close requests
+#define OPTPARSE_IO_URING
+#include <sys/syscall.h>
+#endif
+#endif
 
 class optparse	// add a method to return only a const ref to the map 'parameters'
 {
-	/// Types
+	/// Types
+
+	///	what parse() and retrieve() need, kept small, the text is in metadata
+
+	typedef struct {
+		uint32_t nargs;
+		uint32_t index;	// insertion order: the option's bit in the set-options bitset, and its metadata
+		bool user_option;
+		bool grouped;	// member of an exclusive group, thus not mandatory
+		bool has_default;
+		bool is_mutable;	// may be changed by set() after parse()
+		bool is_expression;	// its value may be arithmetic, folded by parse()
+	} parameters;
+
+	typedef struct {
+		std::string text;	// each description followed by the default value
+		std::vector<std::array<uint32_t, 3>> spans;	// per index: offset, description and default value sizes
+	} metadata;
+
+	typedef struct {
+		bool exclusive;	// at most one member set, or else a dependency
+		bool required;	// exactly one member set
+		std::vector<std::pair<size_t, uint64_t>> masks;	// (word, bits) of the members
+		std::pair<size_t, uint64_t> dependent;	// (word, bit) of the option with requirements
+		std::vector<std::string> members;	// every option involved, looked up one by one after clone()
+		std::string names;	// as shown in the error message
+	} constraint;
+
+	///	32-byte entries in a table starting on a cache line, so that the children 2k and 2k+1
+	///	of an entry share a line
+
+	typedef struct alignas(32) {
+		uint64_t prefix;	// first 8 characters of the key, big-endian, compared first
+		uint32_t key, key_size;	// position in the blob
+		uint32_t value_size;	// the value follows its key in the blob
+		bool has_value;
+	} flat_entry;
+
+	template <typename T>
+	struct line_allocator {
+		typedef T value_type;
+
+		line_allocator() = default;
+
+		template <typename U>
+		line_allocator(line_allocator<U> const&) {}
+
+		auto allocate(size_t n) -> T* { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t {64})); }
+
+		void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t {64}); }
+
+		friend auto operator==(line_allocator const&, line_allocator const&) -> bool { return true; }
+	};
+
+	typedef struct {
+		std::vector<flat_entry, line_allocator<flat_entry>> table;	// sorted, in Eytzinger (breadth-first) order from index 1
+		std::vector<parameters> options;	// same order as table
+		std::string blob;	// key and value characters, one after the other
+	} flat_index;
+
+	/// variables
+
+	std::string program_name;
+
+	std::shared_ptr<const std::map<std::string, parameters>> options;	// shared by copies until one of them changes it
+	std::shared_ptr<const std::map<std::string, std::string>> values;
+	std::map<std::string, std::string> overlay;	// clone() overrides, looked up before values
+
+	std::shared_ptr<const std::map<std::string, std::string>> folded;	// results of arithmetic values, read by numeric retrieves
+	std::shared_ptr<const std::map<std::string, std::vector<std::string>>> referrers;	// option -> the expressions naming it
+
+	std::shared_ptr<const flat_index> frozen;	// replaces options and values after freeze()
+
+	std::span<char* const> positional;	// non-option arguments, a view of argv
+	std::span<char* const> remainder;	// everything after '--', a view of argv
+
+public:
+
+	enum action_t { store_true = 0, store_false = 1 };
+
+	enum sampling_t { uniform_random, latin_hypercube, sobol };
+
+	typedef struct {
+		size_t before;	// estimated bytes held by the maps
+		size_t after;	// bytes held by the flat index
+	} footprint;
+
+	typedef struct {
+		int first;	// argv index of the unrecognized option
+		int last;	// one past the last value it likely consumes
+	} argv_range;
+
+	template <typename T>
+	struct hot_option {
+		uint32_t offset;	// in the hot block
+	};
+
+	template <typename T>
+	struct mutable_option {
+		uint32_t slot;
+	};
+
+	typedef struct {
+		uint32_t index;	// in the compiled schedules
+	} schedule;
+
+	struct digest {
+		uint64_t high;
+		uint64_t low;
+
+		auto operator==(digest const&) const -> bool = default;
+	};
+
+	typedef struct {
+		std::string name;	// 'name[i]' for the i-th value of options taking several
+		std::variant<std::vector<int64_t>, std::vector<double>, std::vector<std::string>> values;
+	} column;
+
+	typedef struct {
+		std::vector<std::string> rows;	// the files read, in order
+		std::vector<column> columns;	// in option name order
+	} table;
+
+	struct difference {
+		enum kind_t { added, removed, changed } kind;
+
+		std::string name;
+		std::string before;	// empty when added
+		std::string after;	// empty when removed
+
+		template <typename T>
+		auto as() const -> std::pair<T, T>;	// before and after converted like retrieve() does
+	};
+
+	template <typename T>
+	struct change {
+		T previous;
+		T current;
+	};
+
+	///	lock-free single-producer single-consumer ring of changes, set() being the producer
+
+	template <typename T>
+	class change_queue {
+
+		std::vector<change<T>> ring;
+
+		alignas(64) std::atomic<size_t> head {0};	// next to pop, written by the consumer
+		alignas(64) std::atomic<size_t> tail {0};	// next to push, written by the producer
+		std::atomic<size_t> overflow {0};
+
+	public:
+
+		explicit change_queue(size_t capacity);
+
+		auto push(change<T> const& event) -> bool;
+
+		auto pop() -> std::optional<change<T>>;
+
+		auto dropped() const -> size_t;
+	};
+
+private:
+
+	bool permissive = false;
+
+	bool accepts_positional = false;
+
+	std::vector<argv_range> unknown;
+
+	mutable std::shared_ptr<const std::map<std::string, std::vector<std::string_view>>> help_index;	// built by the first '--help <term>'
+
+	std::shared_ptr<const std::vector<constraint>> constraints;
+
+	std::shared_ptr<const metadata> cold;	// only read by usage(), dump() and retrieve() defaults
+
+	typedef struct {
+		std::string name;
+		uint32_t offset;
+		void (*convert)(optparse const&, std::string const&, void*);
+	} hot_field;
+
+	std::shared_ptr<const std::vector<hot_field>> hot_fields;
+	uint32_t hot_size = 0;
+
+	std::shared_ptr<const void> hot_block;	// converted hot values, read-only, cache-line aligned
+
+	///	values of the mutable options, each behind a sequence lock: the writer makes the
+	///	sequence odd while storing, readers retry when it was odd or changed meanwhile
+
+	struct alignas(64) seqlock_slot {
+		typedef std::array<uint64_t, 7> words_t;
+
+		std::atomic<uint64_t> sequence {0};
+		std::atomic<uint64_t> words[7] {};
+
+		void store(void const* source, size_t size);
+		void load(void* destination, size_t size) const;
+	};
+
+	typedef struct {
+		std::string name;
+		size_t size;
+		std::type_info const* type;
+		void (*convert)(std::string_view, void*);
+		auto (*format)(void const*) -> std::string;
+	} runtime_field;
+
+	struct runtime_state {
+		std::deque<seqlock_slot> slots;
+		std::mutex writer;	// set() calls are serialized, readers never take it
+
+		std::vector<std::vector<std::function<void(void const*, void const*)>>> subscribers;	// per slot, not copied
+
+		seqlock_slot fingerprint;	// the digest of the effective values, kept up to date by set()
+
+		runtime_state() = default;
+		runtime_state(runtime_state const& other);
+		auto operator=(runtime_state const& other) -> runtime_state&;
+	};
+
+	std::shared_ptr<const std::vector<runtime_field>> runtime_fields;
+
+	runtime_state runtime;
+
+	///	an arithmetic value compiled to postfix: numbers ('n', or 'i' when integral), references
+	///	to other options ('r'), negation ('~') and the binary operators
+
+	typedef struct {
+		char op;
+		double number;
+		int64_t integer;
+		std::string name;
+	} instruction;
+
+	///	options whose value is '@file', a raw or .npy array of numbers mapped read-only
+
+	typedef struct {
+		std::string name;
+		std::type_info const* type;
+		size_t size;		// of an element
+		char kind;			// as in numpy's descr: 'b', 'i', 'u' or 'f'
+		size_t extent;		// number of elements, 0 for any
+	} array_field;
+
+	typedef struct {
+		std::shared_ptr<const void> data;	// unmapped along with the last copy sharing it
+		size_t count;
+		std::string stamp;	// size and modification time of the file, hashed by the fingerprint
+	} mapped_array;
+
+	std::shared_ptr<const std::vector<array_field>> array_fields;
+
+	std::shared_ptr<const std::vector<mapped_array>> arrays;	// one per array field, set by parse()
+
+	///	a schedule such as '300@0, 350@1e6 linear' as segments value = a + b * step, the step
+	///	clamped to [first, last]; buckets of equal width over that range point to the segment
+	///	their start falls in, so a lookup is one bucket read and about one comparison
+
+	typedef struct {
+		double a;
+		double b;
+		double next;	// first step of the following segment
+	} segment;
+
+	typedef struct {
+		double first;
+		double last;
+		double scale;	// buckets per step
+		std::vector<uint32_t> buckets;
+		std::vector<segment> segments;
+	} compiled_schedule;
+
+	std::shared_ptr<const std::vector<std::string>> schedule_fields;
+
+	std::shared_ptr<const std::vector<compiled_schedule>> schedules;	// one per schedule field, set by parse()
+
+public:
+
+	optparse(); /// Constructor
+
+	void insert_option(std::string name, size_t nargs = 1, std::string description = "", std::string default_value = "");
+
+	void insert_option_boolean(std::string name, action_t action, std::string description = "");
+
+	template <typename T>
+	auto insert_option_hot(std::string name, std::string description = "", std::string default_value = "") -> hot_option<T>;
+
+	template <typename T>
+	auto insert_option_mutable(std::string name, std::string description = "", std::string default_value = "") -> mutable_option<T>;
+
+	template <typename T>
+	void insert_option_array(std::string name, size_t extent = 0, std::string description = "");
+
+	auto insert_option_schedule(std::string name, std::string description = "", std::string default_value = "") -> schedule;
+
+	void insert_option_expression(std::string name, size_t nargs = 1, std::string description = "", std::string default_value = "");
+
+	void insert_exclusive_group(std::vector<std::string> names, bool required = false);
+
+	void insert_dependency(std::string name, std::vector<std::string> requirements);
+
+	void allow_unknown(bool allow = true);
+
+	void allow_positional(bool allow = true);
+
+	auto parse(const int argc, char* const* const argv) -> int;
+
+	class config_source;
+
+	auto parse(const int argc, char* const* const argv, config_source const& source) -> int;
+
+	class parse_task;
+
+	auto parse_async(const int argc, char* const* const argv) -> parse_task;
+
+	template <typename T, size_t n=0>
+	T
+	retrieve(std::string name) const;
+
+	template <typename T, typename U>
+	std::pair<T, U>
+	retrieve(std::string name) const;
+
+	template <typename T>
+	T const&
+	retrieve(hot_option<T> option) const;
+
+	template <typename T>
+	T
+	retrieve(mutable_option<T> option) const;
+
+	template <typename T>
+	auto retrieve_list(std::string name) const -> std::vector<T>;
+
+	template <typename U>
+	auto retrieve_span(std::string name) const -> std::span<U>;
+
+	template <typename T>
+	auto retrieve_at(std::string name, double step) const -> T;
+
+	auto retrieve_at(schedule option, double step) const -> double;
+
+	void set(std::string name, std::string value);
+
+	template <typename T>
+	void set(mutable_option<T> option, T const& value);
+
+	template <typename T>
+	void subscribe(mutable_option<T> option, std::function<void(T const& previous, T const& current)> callback);
+
+	template <typename T>
+	auto subscribe(mutable_option<T> option, size_t capacity = 64) -> std::shared_ptr<change_queue<T>>;
+
+	auto arguments() const -> std::span<char* const>;
+
+	auto passthrough() const -> std::span<char* const>;
+
+	auto unknown_arguments() const -> std::vector<argv_range> const&;
+
+	auto suggest(std::string name, size_t k = 3) const -> std::vector<std::string>;
+
+	auto clone(std::map<std::string, std::string> overrides = {}) const -> optparse;
+
+	auto layer(std::string pathname) const -> optparse;
+
+	auto layer(config_source const& source) const -> optparse;
+
+	auto freeze() -> footprint;
+
+	auto fingerprint() const -> digest;
+
+	static auto diff(optparse const& a, optparse const& b) -> std::vector<difference>;
+
+	auto tabulate(std::vector<std::string> const& pathnames) const -> table;
+
+	auto sample(sampling_t strategy, uint64_t k, uint64_t count, uint64_t seed = 0) const -> optparse;
+
+	auto shard(sampling_t strategy, uint64_t count, size_t worker, size_t workers, uint64_t seed = 0) const -> std::vector<optparse>;
+
+	auto dump(std::string pathname) const;
+
+	class config_sink;
+
+	void dump(config_sink const& sink) const;
+
+#ifdef OPTPARSE_UNIX_SOCKETS
+	class control_server;
+
+	auto serve(std::string path) -> std::unique_ptr<control_server>;
+#endif
+
+private:
+
+	void insert_option_impl_(std::string name, parameters const& p, std::string_view description, std::string_view default_value);
+
+	auto description_(parameters const& p) const -> std::string_view;
+
+	auto default_(parameters const& p) const -> std::string_view;
+
+	auto schema_() -> std::map<std::string, parameters>&;
+
+	template <typename T>
+	static auto detach_(std::shared_ptr<const T>& shared) -> T&;
+
+	auto find_option_(std::string const& name) const -> parameters const*;
+
+	auto find_entry_(std::string_view name) const -> size_t;
+
+	static auto prefix_(std::string_view key) -> uint64_t;
+
+	auto find_value_(std::string const& name) const -> std::optional<std::string_view>;
+
+	auto find_number_(std::string const& name) const -> std::optional<std::string_view>;
+
+	template <typename F>
+	void for_each_option_(F&& f) const;
+
+	auto parse_(const int argc, char* const* const argv, config_source const* source) -> int;
+
+	auto load(std::string pathname) const -> std::map<std::string, std::string>;
+
+	auto load(config_source const& source) const -> std::map<std::string, std::string>;
+
+	static auto read_descriptor_(int fd) -> std::string;
+
+	void tokenize_(std::string_view buffer, std::map<std::string, std::string>& values) const;
+
+	void tokenize_lines_(std::string_view buffer, std::map<std::string, std::string>& values) const;
+
+	static auto read_files_(std::vector<std::string> const& paths) -> std::vector<std::string>;
+
+#ifdef OPTPARSE_IO_URING
+	static auto read_files_uring_(std::vector<std::string> const& paths) -> std::optional<std::vector<std::string>>;
+#endif
+
+	auto usage(std::string error_message = "", std::string term = "") const -> int;
+
+	auto search_(std::string const& term) const -> std::vector<std::string_view>;
+
+	auto did_you_mean_(std::string const& name) const -> std::string;
+
+	auto compile_group_(std::vector<std::string> const& names) const -> std::vector<std::pair<size_t, uint64_t>>;
+
+	void validate_groups_(std::vector<std::pair<size_t, uint64_t>> const* overridden = nullptr) const;
+
+	void convert_hot_();
+
+	template <typename T>
+	static void convert_(optparse const& self, std::string const& name, void* destination);
+
+	void convert_runtime_();
+
+	auto find_runtime_(std::string const& name) const -> size_t;
+
+	auto current_(std::string_view key, parameters const& option, std::optional<std::string_view> value) const -> std::string;
+
+	void store_runtime_(size_t slot, void const* value);
+
+	auto entry_digest_(std::string_view key, parameters const& option, std::optional<std::string_view> value) const -> digest;
+
+	static auto hash128_(std::string_view key, std::string_view text) -> digest;
+
+	static auto combine_(digest sum, digest entry, bool remove = false) -> digest;
+
+	typedef struct {
+		std::string name;
+		double low;
+		double high;
+		bool integral;	// both ends are integers, so are the samples
+	} range;
+
+	auto ranges_() const -> std::vector<range>;
+
+	auto sample_(std::vector<range> const& ranges, sampling_t strategy, uint64_t k, uint64_t count, uint64_t seed) const -> optparse;
+
+	static auto unit_(sampling_t strategy, uint64_t k, uint64_t count, uint32_t dimension, uint64_t seed) -> double;
+
+	static auto mix_(uint64_t x) -> uint64_t;
+
+	static auto permute_(uint32_t i, uint32_t l, uint32_t p) -> uint32_t;
+
+	static auto sobol_(uint64_t k, uint32_t dimension) -> uint32_t;
+
+	void fold_expressions_(std::vector<std::string> const* overridden = nullptr);
+
+	auto compile_(std::string_view text, size_t& at, int precedence, std::vector<instruction>& program) const -> bool;
+
+	void map_arrays_();
+
+	void compile_schedules_();
+
+	auto find_schedule_(std::string const& name) const -> size_t;
+
+	static auto compile_schedule_(std::string const& name, std::string_view text) -> compiled_schedule;
+
+	auto find_array_(std::string const& name) const -> size_t;
+
+	static auto map_array_(array_field const& field, std::string const& pathname) -> mapped_array;
+
+	template <typename T>
+	static void parse_(std::string_view text, void* destination);
+
+	template <typename T>
+	static auto format_(void const* value) -> std::string;
+
+	static auto edit_distance_(uint64_t const (&peq)[256], size_t m, std::string_view text) -> size_t;
+};
+
+///	Where settings are read from: a file (or comma-separated fragments, '-' being the standard input),
+///	a descriptor read to its end but left open, or text in memory, tokenized where it is
+
+class optparse::config_source
+{
+	enum class kind_t { file, descriptor, buffer } kind;
+
+	std::string pathname;
+	int fd = -1;
+	std::string_view text;
+
+	explicit config_source(kind_t kind) : kind(kind) {}
+
+	friend class optparse;
+
+public:
+
+	static auto file(std::string pathname) -> config_source;
+
+	static auto descriptor(int fd) -> config_source;
+
+	static auto buffer(std::string_view text) -> config_source;
+
+	static auto standard_input() -> config_source;
+};
+
+///	Where dump() writes to: a file or a string, both appended to, or a descriptor left open
+
+class optparse::config_sink
+{
+	enum class kind_t { file, descriptor, buffer } kind;
+
+	std::string pathname;
+	int fd = -1;
+	std::string* text = nullptr;
+
+	explicit config_sink(kind_t kind) : kind(kind) {}
+
+	friend class optparse;
+
+public:
+
+	static auto file(std::string pathname) -> config_sink;
+
+	static auto descriptor(int fd) -> config_sink;
+
+	static auto buffer(std::string& text) -> config_sink;
+};
+
+///	parse() running on a thread of its own, awaitable from a coroutine or waited for with get();
+///	the optparse object must not be used until then
+
+class optparse::parse_task
+{
+	typedef struct {
+		std::mutex lock;
+		std::condition_variable finished;
+		bool done;
+		int result;
+		std::exception_ptr error;	// thrown by parse(), rethrown by get()
+		std::coroutine_handle<> continuation;
+	} state_t;
+
+	std::shared_ptr<state_t> state;
+	std::thread worker;
+
+public:
+
+	parse_task(optparse& options, const int argc, char* const* const argv);
+
+	parse_task(parse_task&&) = default;
+
+	~parse_task();
+
+	auto get() -> int;
+
+	auto await_ready() const -> bool;
+
+	auto await_suspend(std::coroutine_handle<> continuation) -> bool;
+
+	auto await_resume() -> int;
+};
+
+#ifdef OPTPARSE_UNIX_SOCKETS
+
+///	Serves a parsed optparse on a Unix domain socket, one request per line:
+///		get <name>				ok <value>
+///		set <name> <value>		ok
+///		list					ok <count>, then one '<name>: <value>' line per option
+///	errors are answered with 'error <message>'. Reads don't lock anything, only set() does.
+
+class optparse::control_server
+{
+	optparse& options;
+	std::string path;
+
+	int listener = -1;
+	int stop[2] = {-1, -1};	// self-pipe waking the thread on destruction
+
+	std::thread thread;
+
+public:
+
+	control_server(optparse& options, std::string path);
+
+	~control_server();
+
+	control_server(control_server const&) = delete;
+	auto operator=(control_server const&) -> control_server& = delete;
+
+private:
+
+	void run();
+
+	auto answer(std::string const& request) -> std::string;
+};
+
+#endif
+
+optparse::optparse() :
+	options(std::make_shared<std::map<std::string, parameters>>()),
+	values(std::make_shared<std::map<std::string, std::string>>()),
+	folded(std::make_shared<std::map<std::string, std::string>>()),
+	referrers(std::make_shared<std::map<std::string, std::vector<std::string>>>()),
+	constraints(std::make_shared<std::vector<constraint>>()),
+	cold(std::make_shared<metadata>()),
+	hot_fields(std::make_shared<std::vector<hot_field>>()),
+	runtime_fields(std::make_shared<std::vector<runtime_field>>()),
+	array_fields(std::make_shared<std::vector<array_field>>()),
+	arrays(std::make_shared<std::vector<mapped_array>>()),
+	schedule_fields(std::make_shared<std::vector<std::string>>()),
+	schedules(std::make_shared<std::vector<compiled_schedule>>())
+{
+	insert_option_impl_("help", ((parameters){ .nargs = 0, .index = 0, .user_option = false, .grouped = false, .has_default = false, .is_mutable = false, .is_expression = false }), "Print this message, or only the options matching <term>", "");
+	insert_option_impl_("load", ((parameters){ .nargs = 1, .index = 0, .user_option = false, .grouped = false, .has_default = false, .is_mutable = false, .is_expression = false }), "Load settings from configuration file", "");
+}
+
+void
+optparse::insert_option(std::string name, size_t nargs, std::string description, std::string default_value)
+{
+	auto option_parameters = parameters {
+		.nargs = (uint32_t) nargs,
+		.index = 0,
+		.user_option = true,
+		.grouped = false,
+		.has_default = !default_value.empty(),
+		.is_mutable = false,
+		.is_expression = false
+	};
+
+	insert_option_impl_(name, option_parameters, description, default_value);
+}
+
+void
+optparse::insert_option_boolean(std::string name, action_t action, std::string description)
+{
+	insert_option(name, 0, description, (action == store_true) ? "0" : "1");
+}
+
+template <typename T>
+void
+optparse::insert_option_array(std::string name, size_t extent, std::string description)
+{
+	static_assert(std::is_arithmetic_v<T>, "optparse::insert_option_array: arrays hold integer or floating-point values");
+
+	auto const kind = std::is_same_v<T, bool> ? 'b' : std::is_floating_point_v<T> ? 'f' : std::is_signed_v<T> ? 'i' : 'u';
+
+	insert_option(name, 1, description);
+
+	detach_(array_fields).push_back(array_field { .name = name, .type = &typeid(T), .size = sizeof(T), .kind = kind, .extent = extent });
+}
+
+template <typename U>
+auto
+optparse::retrieve_span(std::string name) const -> std::span<U>
+{
+	static_assert(std::is_const_v<U>, "optparse::retrieve_span: arrays are mapped read-only, retrieve them as const");
+
+	auto const index = find_array_(name);
+
+	if (index == array_fields->size())
+		throw std::invalid_argument("optparse::retrieve_span: not an array option: " + name);
+
+	if (*(*array_fields)[index].type != typeid(std::remove_const_t<U>))
+		throw std::invalid_argument("optparse::retrieve_span: array option must be retrieved as its registered type: " + name);
+
+	if (index >= arrays->size())
+		throw std::invalid_argument("optparse::retrieve no argument has been passed to option: " + name);
+
+	auto const& array = (*arrays)[index];
+
+	return std::span<U>(static_cast<U*>(array.data.get()), array.count);
+}
+
+template <typename T>
+auto
+optparse::retrieve_at(std::string name, double step) const -> T
+{
+	auto const index = find_schedule_(name);
+
+	if (index == schedule_fields->size())
+		throw std::invalid_argument("optparse::retrieve_at: not a schedule option: " + name);
+
+	return static_cast<T>(retrieve_at(schedule { .index = static_cast<uint32_t>(index) }, step));
+}
+
+template <typename T>
+auto
+optparse::retrieve_list(std::string name) const -> std::vector<T>
+{
+	static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "optparse::retrieve_list: lists hold integer or floating-point values, not bool");
+
+	///	Every value of an option with any number of them, in one pass: the digits are consumed
+	///	by from_chars (Eisel-Lemire for floating point) and only the separators are looked at here
+
+	auto text = std::string_view {};
+
+	if (auto option = find_option_(name); option && option->is_mutable)
+		throw std::invalid_argument("optparse::retrieve_list: mutable option must be retrieved as its registered type: " + name);
+
+	else if (auto stored = find_number_(name))
+		text = *stored;
+
+	else if (option && option->has_default && option->nargs != 0)
+		text = default_(*option);
+
+	else
+		throw std::invalid_argument("optparse::retrieve no argument has been passed to option: " + name);
+
+	auto values = std::vector<T> {};
+
+	if (text.empty())
+		return values;
+
+	values.reserve(std::count(text.begin(), text.end(), ',') +1);
+
+	for (auto first = text.data(), last = text.data() + text.size(); ; ++first)
+	{
+		while (first != last && *first == ' ')
+			++first;
+
+		auto const token = first;
+
+		auto [next, error] = std::from_chars(token, last, values.emplace_back());
+
+		for (first = next; first != last && *first == ' '; )
+			++first;
+
+		if (error != std::errc {} || (first != last && *first != ','))
+		{
+			auto const argument = std::string_view(token, last - token);
+
+			throw std::runtime_error("Invalid conversion of the argument '" + std::string(argument.substr(0, argument.find(','))) + \
+					"' to type " + typeid(T).name());
+		}
+
+		if (first == last)
+			break;
+	}
+	return values;
+}
+
+template <typename T>
+auto
+optparse::insert_option_hot(std::string name, std::string description, std::string default_value) -> hot_option<T>
+{
+	static_assert(std::is_trivially_copyable_v<T>, "optparse::insert_option_hot: hot options hold trivially copyable values");
+
+	insert_option(name, 1, description, default_value);
+
+	auto const offset = static_cast<uint32_t>((hot_size + alignof(T) - 1) / alignof(T) * alignof(T));
+
+	detach_(hot_fields).push_back(hot_field { .name = name, .offset = offset, .convert = &convert_<T> });
+	hot_size = offset + sizeof(T);
+
+	return hot_option<T> { .offset = offset };
+}
+
+template <typename T>
+auto
+optparse::insert_option_mutable(std::string name, std::string description, std::string default_value) -> mutable_option<T>
+{
+	static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(seqlock_slot::words), "optparse::insert_option_mutable: mutable options hold small trivially copyable values");
+
+	insert_option(name, 1, description, default_value);
+
+	schema_().at(name).is_mutable = true;
+
+	detach_(runtime_fields).push_back(runtime_field { .name = name, .size = sizeof(T), .type = &typeid(T), .convert = &parse_<T>, .format = &format_<T> });
+
+	return mutable_option<T> { .slot = static_cast<uint32_t>(runtime_fields->size() - 1) };
+}
+
+void
+optparse::insert_exclusive_group(std::vector<std::string> names, bool required)
+{
+	auto& schema = schema_();	// throws once frozen
+
+	auto group = constraint {
+		.exclusive = true,
+		.required = required,
+		.masks = compile_group_(names),
+		.dependent = {},
+		.members = names,
+		.names = {}
+	};
+
+	for (auto const& name: names)
+	{
+		schema.at(name).grouped = true;
+		group.names += (group.names.empty() ? "--" : ", --") + name;
+	}
+	detach_(constraints).push_back(group);
+}
+
+void
+optparse::insert_dependency(std::string name, std::vector<std::string> requirements)
+{
+	if (frozen)
+		throw std::logic_error("optparse::insert_dependency: the options are frozen");
+
+	auto group = constraint {
+		.exclusive = false,
+		.required = false,
+		.masks = compile_group_(requirements),
+		.dependent = compile_group_({name}).front(),
+		.members = requirements,
+		.names = "--" + name + " requires"
+	};
+
+	group.members.push_back(name);
+
+	for (auto const& requirement: requirements)
+		group.names += (group.names.back() == 's' ? " --" : ", --") + requirement;
+
+	detach_(constraints).push_back(group);
+}
+
+void
+optparse::allow_unknown(bool allow)
+{
+	permissive = allow;
+}
+
+void
+optparse::allow_positional(bool allow)
+{
+	accepts_positional = allow;
+}
+
+auto
+optparse::parse(const int argc, char* const* const argv) -> int
+{
+	return parse_(argc, argv, nullptr);
+}
+
+auto
+optparse::parse(const int argc, char* const* const argv, config_source const& source) -> int
+{
+	///	the settings of source sit beneath the ones of --load, which sit beneath the command line
+
+	return parse_(argc, argv, &source);
+}
+
+auto
+optparse::parse_(const int argc, char* const* const argv, config_source const* source) -> int
+{
+	auto ierr = int {0};
+
+	program_name = std::string(argv[0]);
+
+	positional = remainder = std::span<char* const> {};
+
+	unknown.clear();
+
+	/// Try to process all the arguments
+
+	try
+	{
+		if (frozen)
+			throw std::logic_error("optparse::parse: the options are frozen");
+
+		auto& stored = detach_(values);
+
+		/// Loop over argv[], ignoring the first argument
+
+		for (int i = 1; i < argc; ++i)
+		{
+			auto idx = strspn(argv[i], "-");
+
+			auto key = std::string(&argv[i][idx]);
+
+			//~ '--' ends the options, what follows is handed over untouched (e.g. to execv)
+
+			if (idx == 2 && key.empty())
+			{
+				remainder = std::span(argv + i + 1, argv + argc);
+				break;
+			}
+
+			//~ after allow_positional(), the first non-option argument (or a lone '-') starts the
+			//	positional arguments, which run up to '--' or the end of argv. Otherwise it's
+			//	rejected: a bare word is never looked up as an option
+
+			if (accepts_positional && (!idx || (idx == 1 && key.empty())))
+			{
+				auto last = i;
+
+				for (; last < argc && std::strcmp(argv[last], "--"); ++last)
+				{
+					auto const name = argv[last] + strspn(argv[last], "-");
+
+					if (argv[last][0] == '-' && options->count(name))
+						throw std::invalid_argument("optparse::parse: option given after the positional arguments: " + std::string(argv[last]));
+				}
+
+				positional = std::span(argv + i, argv + last);
+
+				if (last < argc)
+					remainder = std::span(argv + last + 1, argv + argc);
+
+				break;
+			}
+
+			if (!idx)
+				throw std::invalid_argument("optparse::parse: argument options must start with a single/double dash"); // invalid argument
+
+			if (!key.compare("help"))
+			{
+				auto const term = (i + 1 < argc && argv[i + 1][0] != '-') ? std::string(argv[i + 1]) : std::string {};
+
+				ierr = usage("", term);
+				break;
+			}
+
+			//~ there's an argument option and it isn't --help
+
+			if (auto option = options->find(key); option == options->end() && permissive)
+			{
+				//~ record it for the caller, guessing that the following non-option arguments
+				//	are its values ('--key=value' carries its own)
+
+				auto last = i + 1;
+
+				if (key.find('=') == std::string::npos)
+					while (last < argc && (argv[last][0] != '-' || std::isdigit(static_cast<unsigned char>(argv[last][1])) || argv[last][1] == '.'))
+						++last;
+
+				unknown.push_back(argv_range { .first = i, .last = last });
+
+				i = last - 1;
+			}
+
+			else if (option == options->end())
+				throw std::invalid_argument("optparse::parse: unknow argument: " + key + did_you_mean_(key));
+
+			else
+			{
+				auto value = std::string {};
+
+				if (option->second.nargs == 0)
+					value = std::to_string(default_(option->second) == "0");	// invert bool "0" -> 1
+
+				else if (argc - i < (int) option->second.nargs +1)
+					throw std::runtime_error("optparse::parse: insufficient number of argument values");
+
+				else // ok, there's enough argument values, process all of them
+				{
+					value = std::string(argv[++i]);
+
+					for (int j = 1; j < (int) option->second.nargs; ++j)
+						value += ", " + std::string(argv[++i]);
+				}
+
+				if (const auto &[it, inserted] = stored.try_emplace(key, value); !inserted)
+					throw std::runtime_error("optparse::parse: duplicate option passed by command line: " + key);
+			}
+		}
+
+		if (ierr == 0x00)
+		{
+			/// Read and transfer option values from the configuration file
+
+			if (auto value = stored.find("load"); value != stored.end())
+			{
+				stored.merge(load(value->second));
+				stored.erase("load");
+			}
+
+			if (source)
+				stored.merge(load(*source));
+
+			fold_expressions_();
+
+			/// Post processing -- check for every option besides load and help
+
+			for_each_option_([](std::string_view key, parameters const& option, std::optional<std::string_view> value)
+			{
+				if (!option.user_option)
+					return;
+
+				if (!value && !option.has_default && !option.grouped)
+					throw std::invalid_argument("optparse::parse: missing argument(s), e.g., " + std::string(key));
+			});
+
+			validate_groups_();
+
+			convert_hot_();
+
+			convert_runtime_();
+
+			map_arrays_();
+
+			compile_schedules_();
+
+			auto sum = digest {};
+
+			for_each_option_([&](std::string_view key, parameters const& option, std::optional<std::string_view> value)
+			{
+				if (option.user_option)
+					sum = combine_(sum, entry_digest_(key, option, value));
+			});
+
+			runtime.fingerprint.store(&sum, sizeof(sum));
+		}
+	}
+	catch (const std::exception& e)
+	{
+		ierr = usage(e.what());
+	}
+	return ierr;
+}
+
+auto
+optparse::parse_async(const int argc, char* const* const argv) -> parse_task
+{
+	///	reading the configuration file overlaps with whatever the caller does meanwhile
+
+	return parse_task(*this, argc, argv);
+}
+
+optparse::parse_task::parse_task(optparse& options, const int argc, char* const* const argv) :
+	state(std::make_shared<state_t>())
+{
+	state->done = false;
+
+	worker = std::thread([state = state, &options, argc, argv]
+	{
+		auto result = int {0};
+		auto error = std::exception_ptr {};
+
+		try
+		{
+			result = options.parse(argc, argv);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+
+		auto continuation = std::coroutine_handle<> {};
+		{
+			auto const guard = std::lock_guard(state->lock);
+
+			state->result = result;
+			state->error = error;
+			state->done = true;
+			continuation = std::exchange(state->continuation, nullptr);
+		}
+		state->finished.notify_all();
+
+		/// An awaiting coroutine is resumed here, on the parsing thread
+
+		if (continuation)
+			continuation.resume();
+	});
+}
+
+optparse::parse_task::~parse_task()
+{
+	if (!worker.joinable())
+		return;
+
+	if (worker.get_id() == std::this_thread::get_id())
+		worker.detach();	// destroyed by the coroutine it resumed
+	else
+		worker.join();
+}
+
+auto
+optparse::parse_task::get() -> int
+{
+	auto guard = std::unique_lock(state->lock);
+
+	state->finished.wait(guard, [this] { return state->done; });
+
+	if (state->error)
+		std::rethrow_exception(state->error);
+
+	return state->result;
+}
+
+auto
+optparse::parse_task::await_ready() const -> bool
+{
+	auto const guard = std::lock_guard(state->lock);
+
+	return state->done;
+}
+
+auto
+optparse::parse_task::await_suspend(std::coroutine_handle<> continuation) -> bool
+{
+	///	false resumes the caller at once, parsing finished in the meantime
+
+	auto const guard = std::lock_guard(state->lock);
+
+	if (state->done)
+		return false;
+
+	state->continuation = continuation;
+
+	return true;
+}
+
+auto
+optparse::parse_task::await_resume() -> int
+{
+	return get();
+}
+
+template <typename T, size_t n>
+T
+optparse::retrieve(std::string name) const
+{
+	auto value = T {};
+
+	/// Lambda function to split the option values' string
+
+	static auto const split = [](std::string_view s, int pos)
+	{
+		auto [start, end] = std::pair(size_t {0}, s.find(","));
+
+		for (int i = 0; end != std::string::npos; ++i)
+	   	{
+			if (i == pos)
+				return std::string(s.substr(start, end - start));
+
+			start = end + 1;
+   		    end = s.find(",", start);
+	   	}
+		return std::string(s.substr(start, end));
+	};
+
+	/// Search the name in the options, mutable ones are read from their slot
+
+	if (auto option = find_option_(name); option && option->is_mutable && !runtime.slots.empty())
+	{
+		auto const slot = find_runtime_(name);
+
+		if (*(*runtime_fields)[slot].type != typeid(T) || n != 0)
+			throw std::invalid_argument("optparse::retrieve: mutable option must be retrieved as its registered type: " + name);
+
+		if constexpr (std::is_trivially_copyable_v<T>)
+			runtime.slots[slot].load(&value, sizeof(T));
+	}
+	else if (auto stored = std::is_arithmetic_v<T> ? find_number_(name) : find_value_(name))
+	{
+		auto argument = split(*stored, n);
+
+		if (!(std::stringstream(argument) >> value))
+			throw std::runtime_error("Invalid conversion of the argument '" + argument + "' to type " + typeid(T).name());
+	}
+	else if (auto option = find_option_(name); option && option->has_default)
+	{
+		auto argument = option->nargs == 0 ?
+			std::to_string(default_(*option) != "0") :
+			split(default_(*option), n);
+
+		if (!(std::stringstream(argument) >> value))
+			throw std::runtime_error("Invalid conversion of the argument '" + argument + "' to type " + typeid(T).name());
+	}
+	else
+		throw std::invalid_argument("optparse::retrieve no argument has been passed to option: " + name);
+
+	return value;
+}
+
+template <typename T, typename U>
+std::pair<T, U>
+optparse::retrieve(std::string name) const
+{
+	return std::pair(retrieve<T, 0>(name), retrieve<U, 1>(name));
+}
+
+template <typename T>
+T const&
+optparse::retrieve(hot_option<T> option) const
+{
+	///	no lookup nor conversion, the values were converted by parse() or clone()
+
+	assert(hot_block);
+
+	return *std::launder(reinterpret_cast<T const*>(static_cast<std::byte const*>(hot_block.get()) + option.offset));
+}
+
+template <typename T>
+T
+optparse::retrieve(mutable_option<T> option) const
+{
+	///	wait-free for other readers, retried only while set() is storing this very option
+
+	assert(option.slot < runtime.slots.size());
+
+	auto value = T {};
+
+	runtime.slots[option.slot].load(&value, sizeof(T));
+
+	return value;
+}
+
+void
+optparse::set(std::string name, std::string value)
+{
+	auto const option = find_option_(name);
+
+	if (!option)
+		throw std::invalid_argument("optparse::set: unknow argument: " + name + did_you_mean_(name));
+
+	if (!option->is_mutable || runtime.slots.empty())
+		throw std::invalid_argument("optparse::set: option isn't mutable, or options weren't parsed: " + name);
+
+	/// Converted once, here, readers only copy the bytes
+
+	auto const slot = find_runtime_(name);
+
+	seqlock_slot::words_t converted {};
+
+	(*runtime_fields)[slot].convert(value, &converted);
+
+	store_runtime_(slot, &converted);
+}
+
+template <typename T>
+void
+optparse::set(mutable_option<T> option, T const& value)
+{
+	assert(option.slot < runtime.slots.size());
+
+	store_runtime_(option.slot, &value);
+}
+
+auto
+optparse::arguments() const -> std::span<char* const>
+{
+	return positional;
+}
+
+auto
+optparse::passthrough() const -> std::span<char* const>
+{
+	///	the view ends at argv[argc], which is a null pointer, so data() can be given to execv as is
+
+	return remainder;
+}
+
+auto
+optparse::unknown_arguments() const -> std::vector<argv_range> const&
+{
+	///	only filled by parse() after allow_unknown(), the ranges are in argv order
+
+	return unknown;
+}
+
+auto
+optparse::suggest(std::string name, size_t k) const -> std::vector<std::string>
+{
+	auto candidates = std::vector<std::pair<size_t, std::string_view>> {};
+
+	/// Nothing is indexed beforehand, this only runs on the error path. The name is
+	///	truncated to a machine word, so each option costs a handful of word operations
+	///	per character with the bit-parallel kernel of Myers/Hyyro.
+
+	auto const m = std::min<size_t>(name.size(), 64);
+
+	if (m == 0 || k == 0)
+		return {};
+
+	uint64_t peq[256] = {};
+
+	for (size_t i = 0; i < m; ++i)
+		peq[static_cast<unsigned char>(name[i])] |= uint64_t {1} << i;
+
+	auto const threshold = std::max<size_t>(2, m / 3);
+
+	for_each_option_([&](std::string_view key, parameters const&, std::optional<std::string_view>)
+	{
+		if (std::max(key.size(), m) - std::min(key.size(), m) > threshold)
+			return;
+
+		if (auto distance = edit_distance_(peq, m, key); distance <= threshold)
+			candidates.emplace_back(distance, key);
+	});
+
+	auto const top = std::min(k, candidates.size());
+
+	std::partial_sort(candidates.begin(), candidates.begin() + top, candidates.end(),
+			[](auto const& a, auto const& b) { return a.first < b.first || (a.first == b.first && a.second < b.second); });
+
+	auto suggestions = std::vector<std::string> {};
+
+	for (size_t i = 0; i < top; ++i)
+		suggestions.emplace_back(candidates[i].second);
+
+	return suggestions;
+}
+
+auto
+optparse::clone(std::map<std::string, std::string> overrides) const -> optparse
+{
+	/// The copy shares the schema and the parsed values with this object, only the
+	///	overrides are its own, on top of the ones this object may have
+
+	auto copy = *this;
+
+	for (auto& [key, value]: overrides)
+	{
+		auto option = find_option_(key);
+
+		if (!option || !option->user_option)
+			throw std::invalid_argument("optparse::clone: unknow argument: " + key + did_you_mean_(key));
+
+		if (auto nargs = std::max<size_t>(option->nargs, 1); find_schedule_(key) == schedule_fields->size() && (size_t) std::count(value.begin(), value.end(), ',') + 1 != nargs)
+			throw std::invalid_argument("optparse::clone: wrong number of argument values for option: " + key);
+
+		copy.overlay.insert_or_assign(key, std::move(value));
+	}
+
+	auto names = std::vector<std::string> {};
+
+	for (auto const& [key, value]: overrides)
+		names.push_back(key);
+
+	if (!constraints->empty())
+	{
+		auto const overridden = compile_group_(names);
+
+		copy.validate_groups_(&overridden);
+	}
+
+	copy.fold_expressions_(&names);
+
+	///	converted values are redone when overridden, or when an override moved the result of their expression
+
+	auto const changed = [&](std::string const& name)
+	{
+		auto const before = folded->find(name);
+		auto const after = copy.folded->find(name);
+
+		if (before == folded->end() || after == copy.folded->end())
+			return overrides.count(name) || (before == folded->end()) != (after == copy.folded->end());
+
+		return overrides.count(name) || before->second != after->second;
+	};
+
+	for (auto const& field: *hot_fields)
+	{
+		if (changed(field.name))
+		{
+			copy.convert_hot_();
+			break;
+		}
+	}
+
+	for (auto const& field: *array_fields)
+	{
+		if (overrides.count(field.name))
+		{
+			copy.map_arrays_();
+			break;
+		}
+	}
+
+	for (auto const& name: *schedule_fields)
+	{
+		if (overrides.count(name))
+		{
+			copy.compile_schedules_();
+			break;
+		}
+	}
+
+	///	the fingerprint moves by the overridden entries, the only texts that changed; mutable
+	///	ones are taken care of by store_runtime_()
+
+	auto sum = copy.fingerprint();
+
+	for (auto const& key: names)
+	{
+		if (auto option = find_option_(key); !option->is_mutable)
+		{
+			sum = combine_(sum, entry_digest_(key, *option, find_value_(key)), true);
+			sum = combine_(sum, copy.entry_digest_(key, *option, copy.find_value_(key)));
+		}
+	}
+	copy.runtime.fingerprint.store(&sum, sizeof(sum));
+
+	for (size_t slot = 0; slot < copy.runtime.slots.size(); ++slot)
+	{
+		if (auto const& field = (*runtime_fields)[slot]; changed(field.name))
+		{
+			seqlock_slot::words_t converted {};
+
+			field.convert(*copy.find_number_(field.name), &converted);
+			copy.store_runtime_(slot, &converted);
+		}
+	}
+	return copy;
+}
+
+auto
+optparse::layer(std::string pathname) const -> optparse
+{
+	///	only the delta file is read, lookups fall through its values to the ones of this object
+
+	return clone(load(pathname));
+}
+
+auto
+optparse::layer(config_source const& source) const -> optparse
+{
+	return clone(load(source));
+}
+
+auto
+optparse::freeze() -> footprint
+{
+	if (frozen)
+		return footprint { .before = 0, .after = 0 };
+
+	static auto const heap = [](std::string const& s) { return s.capacity() > 15 ? s.capacity() + 1 : 0; };
+
+	constexpr auto node = size_t {32};	// red-black tree node header, libstdc++
+
+	auto usage = footprint { .before = 0, .after = 0 };
+
+	/// Copy the option names, each followed by its value, into a single blob
+
+	auto index = std::make_shared<flat_index>();
+
+	auto sorted = std::vector<std::pair<flat_entry, parameters const*>> {};
+
+	auto value = values->begin();
+
+	for (auto const& [key, option]: *options)
+	{
+		usage.before += node + sizeof(std::pair<const std::string, parameters>) + heap(key);
+
+		auto entry = flat_entry { .prefix = prefix_(key), .key = (uint32_t) index->blob.size(), .key_size = (uint32_t) key.size(), .value_size = 0, .has_value = false };
+
+		index->blob += key;
+
+		if (value != values->end() && value->first == key)
+		{
+			usage.before += node + sizeof(std::pair<const std::string, std::string>) + heap(value->first) + heap(value->second);
+
+			entry.value_size = value->second.size();
+			entry.has_value = true;
+			index->blob += (value++)->second;
+		}
+		sorted.emplace_back(entry, &option);
+	}
+	index->blob.shrink_to_fit();
+
+	/// Eytzinger layout: filling the implicit tree (children of k at 2k, 2k+1) in order
+	///	with the sorted entries, the slot 0 is unused
+
+	index->table.resize(sorted.size() + 1);
+	index->options.resize(sorted.size() + 1);
+
+	auto next = sorted.begin();
+
+	auto const fill = [&](auto const& self, size_t k) -> void
+	{
+		if (k >= index->table.size())
+			return;
+
+		self(self, 2 * k);
+		index->table[k] = next->first;
+		index->options[k] = *(next++)->second;
+		self(self, 2 * k + 1);
+	};
+	fill(fill, 1);
+
+	usage.after = sizeof(flat_index) + index->table.capacity() * sizeof(flat_entry) + index->options.capacity() * sizeof(parameters) + index->blob.capacity();
+
+	/// Drop this object's references to the maps (copies may still share them)
+
+	frozen = index;
+	options.reset();
+	values.reset();
+	help_index.reset();
+
+	return usage;
+}
+
+auto
+optparse::dump(std::string pathname) const
+{
+	dump(config_sink::file(pathname));
+}
+
+void
+optparse::dump(config_sink const& sink) const
+{
+	std::ostringstream config;
+
+	std::time_t result = std::time(nullptr);
+
+	char mbstr[100];
+
+	///	writes standard date and time string, e.g. Sun Oct 17 04:41:13 2010 (locale dependent)
+
+	if (std::strftime(mbstr, sizeof(mbstr), "%c", std::localtime(&result)))
+	{
+		config << "\n# Created automaticaly by optparse on " << std::string(mbstr) << '\n' << std::endl;
+    }
+	else
+		config << "\n# Created automaticaly by optparse" << '\n' << std::endl;
+
+	for_each_option_([this, &config](std::string_view key, parameters const& option, std::optional<std::string_view> value)
+	{
+		if (value || option.user_option)
+			config << key << ": " << current_(key, option, value) << '\n';
+	});
+	config << std::endl;
+
+	auto const text = config.str();
+
+	switch (sink.kind)
+	{
+		case config_sink::kind_t::buffer:
+			sink.text->append(text);
+			break;
+
+		case config_sink::kind_t::file:
+		{
+			std::ofstream file(sink.pathname, std::ios::app);
+
+			if (!file.is_open())
+				throw std::runtime_error("optparse::parse: opening file '" + sink.pathname + \
+						"' failed, it either doesn't exist or is not accessible.");
+
+			file << text;
+			break;
+		}
+		case config_sink::kind_t::descriptor:
+#ifdef OPTPARSE_POSIX
+			for (size_t offset = 0; offset < text.size(); )
+			{
+				auto bytes = ::write(sink.fd, text.data() + offset, text.size() - offset);
+
+				if (bytes < 0 && errno == EINTR)
+					continue;
+
+				if (bytes < 0)
+					throw std::runtime_error("optparse::dump: writing to descriptor " + std::to_string(sink.fd) + " failed: " + std::strerror(errno));
+
+				offset += bytes;
+			}
+#else
+			throw std::logic_error("optparse::dump: descriptors are only supported on POSIX systems");
+#endif
+			break;
+	}
+}
+
+#ifdef OPTPARSE_UNIX_SOCKETS
+
+auto
+optparse::serve(std::string path) -> std::unique_ptr<control_server>
+{
+	///	the server thread runs until the returned object is destroyed, which must happen before this one
+
+	return std::make_unique<control_server>(*this, path);
+}
+
+optparse::control_server::control_server(optparse& options, std::string path) :
+	options(options),
+	path(path)
+{
+	auto address = sockaddr_un { .sun_family = AF_UNIX, .sun_path = {} };
+
+	if (path.size() >= sizeof(address.sun_path))
+		throw std::invalid_argument("optparse::serve: socket path too long: " + path);
+
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+	/// Only a socket nobody listens on any longer is replaced, anything else at path is left alone
+
+	if (struct stat status; ::lstat(path.c_str(), &status) == 0)
+	{
+		if (!S_ISSOCK(status.st_mode))
+			throw std::runtime_error("optparse::serve: '" + path + "' exists and isn't a socket");
+
+		auto probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+
+		auto const live = probe >= 0 && (::connect(probe, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == 0 || errno == EAGAIN);
+
+		if (probe >= 0)
+			::close(probe);
+
+		if (live)
+			throw std::runtime_error("optparse::serve: '" + path + "' is in use by another server");
+
+		::unlink(path.c_str());
+	}
+
+	listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) < 0
+			|| ::listen(listener, 8) < 0 || ::pipe2(stop, O_CLOEXEC) < 0)
+	{
+		auto const error = std::string(std::strerror(errno));
+
+		if (listener >= 0)
+			::close(listener);
+
+		throw std::runtime_error("optparse::serve: listening on '" + path + "' failed: " + error);
+	}
+	thread = std::thread(&control_server::run, this);
+}
+
+optparse::control_server::~control_server()
+{
+	[[maybe_unused]] auto const written = ::write(stop[1], "", 1);
+
+	thread.join();
+
+	::close(stop[0]);
+	::close(stop[1]);
+	::close(listener);
+	::unlink(path.c_str());
+}
+
+void
+optparse::control_server::run()
+{
+	///	A single thread polls the listener and every client, requests are short. Clients don't
+	///	block: a reply not read yet waits in its queue, and the requests of that client are only
+	///	answered once it's gone, one at a time, so a client that stops reading stalls itself alone
+
+	typedef struct {
+		std::string requests;	// received, not answered yet
+		std::string replies;	// answered, not sent yet
+		bool closed;			// nothing more to receive
+	} peer;
+
+	auto const flush = [](int fd, std::string& replies)
+	{
+		while (!replies.empty())
+		{
+			auto const sent = ::send(fd, replies.data(), replies.size(), MSG_NOSIGNAL);
+
+			if (sent < 0)
+				return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+			replies.erase(0, sent);
+		}
+		return true;
+	};
+
+	auto fds = std::vector<pollfd> { {stop[0], POLLIN, 0}, {listener, POLLIN, 0} };
+	auto peers = std::vector<peer> {2};
+
+	while (::poll(fds.data(), fds.size(), -1) >= 0 || errno == EINTR)
+	{
+		if (fds[0].revents)
+			break;
+
+		if (fds[1].revents & POLLIN)
+		{
+			if (auto client = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK); client >= 0)
+			{
+				fds.push_back({client, POLLIN, 0});
+				peers.push_back(peer { .requests = {}, .replies = {}, .closed = false });
+			}
+		}
+
+		for (size_t i = 2; i < fds.size(); ++i)
+		{
+			if (!fds[i].revents)
+				continue;
+
+			auto& client = peers[i];
+
+			if (fds[i].revents & (POLLIN | POLLHUP | POLLERR) && client.replies.empty() && !client.closed)
+			{
+				char buffer[4096];
+
+				auto const received = ::recv(fds[i].fd, buffer, sizeof(buffer), 0);
+
+				if (received > 0)
+					client.requests.append(buffer, received);
+
+				else if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+					client.closed = true;
+			}
+
+			auto sending = flush(fds[i].fd, client.replies);
+
+			for (auto end = client.requests.find('\n'); sending && client.replies.empty() && end != std::string::npos; end = client.requests.find('\n'))
+			{
+				client.replies = answer(client.requests.substr(0, end));
+				client.requests.erase(0, end + 1);
+
+				sending = flush(fds[i].fd, client.replies);
+			}
+
+			fds[i].events = client.replies.empty() ? POLLIN : POLLOUT;
+
+			if (!sending || client.requests.size() > 65536 || (client.closed && client.replies.empty()))
+			{
+				::close(fds[i].fd);
+				fds.erase(fds.begin() + i);
+				peers.erase(peers.begin() + i--);
+			}
+		}
+	}
+	for (size_t i = 2; i < fds.size(); ++i)
+		::close(fds[i].fd);
+}
+
+auto
+optparse::control_server::answer(std::string const& request) -> std::string
+{
+	auto words = std::istringstream(request);
+
+	auto command = std::string {};
+	auto name = std::string {};
+
+	words >> command >> name;
+
+	try
+	{
+		if (command == "get" && name.length())
+		{
+			auto const option = options.find_option_(name);
+
+			if (!option)
+				throw std::invalid_argument("unknow argument: " + name + options.did_you_mean_(name));
+
+			return "ok " + options.current_(name, *option, options.find_value_(name)) + '\n';
+		}
+
+		if (command == "set" && name.length())
+		{
+			auto value = std::string {};
+
+			std::getline(words >> std::ws, value);
+			options.set(name, value);
+
+			return "ok\n";
+		}
+
+		if (command == "list")
+		{
+			auto lines = std::string {};
+			auto count = 0;
+
+			options.for_each_option_([&](std::string_view key, parameters const& option, std::optional<std::string_view> value)
+			{
+				if (!option.user_option)
+					return;
+
+				lines.append(key).append(": ").append(options.current_(key, option, value)).append("\n");
+				++count;
+			});
+			return "ok " + std::to_string(count) + '\n' + lines;
+		}
+		return "error unknown request, expected: get <name> | set <name> <value> | list\n";
+	}
+	catch (const std::exception& e)
+	{
+		return "error " + std::string(e.what()) + '\n';
+	}
+}
+
+#endif
+
+// private methods
+
+void
+optparse::insert_option_impl_(std::string name, parameters const& p, std::string_view description, std::string_view default_value)
+{
+
+	auto& schema = schema_();
+
+	if (const auto &[it, inserted] = schema.try_emplace(name, p); !inserted)
+		throw std::invalid_argument("optparse::insert_option: option already exists: " + name);
+
+	else
+		it->second.index = schema.size() - 1;
+
+	auto& text = detach_(cold);
+
+	text.spans.push_back({ (uint32_t) text.text.size(), (uint32_t) description.size(), (uint32_t) default_value.size() });
+	text.text.append(description).append(default_value);
+}
+
+auto
+optparse::description_(parameters const& p) const -> std::string_view
+{
+	auto const& [offset, description, default_value] = cold->spans[p.index];
+
+	return std::string_view(cold->text).substr(offset, description);
+}
+
+auto
+optparse::default_(parameters const& p) const -> std::string_view
+{
+	auto const& [offset, description, default_value] = cold->spans[p.index];
+
+	return std::string_view(cold->text).substr(offset + description, default_value);
+}
+
+auto
+optparse::schema_() -> std::map<std::string, parameters>&
+{
+	if (frozen)
+		throw std::logic_error("optparse::insert_option: the options are frozen");
+
+	///	the help index refers to the option names, it's rebuilt on demand
+
+	help_index.reset();
+
+	return detach_(options);
+}
+
+template <typename T>
+auto
+optparse::detach_(std::shared_ptr<const T>& shared) -> T&
+{
+	///	copy on write, a copy sharing the object gets its own before changing it
+
+	if (shared.use_count() > 1)
+		shared = std::make_shared<T>(*shared);
+
+	return const_cast<T&>(*shared);
+}
+
+auto
+optparse::find_option_(std::string const& name) const -> parameters const*
+{
+	if (!frozen)
+	{
+		auto option = options->find(name);
+		return option == options->end() ? nullptr : &option->second;
+	}
+
+	auto k = find_entry_(name);
+
+	return k ? &frozen->options[k] : nullptr;
+}
+
+auto
+optparse::find_entry_(std::string_view name) const -> size_t
+{
+	/// Branchless descent of the Eytzinger layout, both children share a cache line and the
+	///	grandchildren are prefetched; the trailing ones of k are the final right turns. Keys
+	///	are compared by their first 8 characters, the rest only on ties
+
+	auto const& table = frozen->table;
+	auto const n = table.size() - 1;
+
+	auto const prefix = prefix_(name);
+	auto const tail = name.size() > 8 ? name.substr(8) : std::string_view {};
+
+	auto const less = [&](flat_entry const& entry)
+	{
+		if (entry.prefix != prefix)
+			return entry.prefix < prefix;
+
+		auto const key = std::string_view(frozen->blob).substr(entry.key, entry.key_size);
+		return (key.size() > 8 ? key.substr(8) : std::string_view {}) < tail;
+	};
+
+	auto k = size_t {1};
+
+	while (k <= n)
+	{
+		__builtin_prefetch(table.data() + 4 * k);
+		__builtin_prefetch(table.data() + 4 * k + 2);
+		k = 2 * k + less(table[k]);
+	}
+	k >>= std::countr_one(k) + 1;
+
+	return (k && std::string_view(frozen->blob).substr(table[k].key, table[k].key_size) == name) ? k : 0;
+}
+
+auto
+optparse::prefix_(std::string_view key) -> uint64_t
+{
+	auto prefix = uint64_t {0};
+
+	for (size_t i = 0; i < 8; ++i)
+		prefix = (prefix << 8) | (i < key.size() ? static_cast<unsigned char>(key[i]) : 0);
+
+	return prefix;
+}
+
+auto
+optparse::diff(optparse const& a, optparse const& b) -> std::vector<difference>
+{
+	///	Both sides are walked in name order and merge-joined, the values compared in place:
+	///	only the differences are copied out, or rendered for mutable options
+
+	typedef struct {
+		std::string_view key;
+		parameters const* option;
+		std::optional<std::string_view> value;
+	} entry;
+
+	///	the stored text, not a folded result: different expressions may well fold to the same number
+
+	auto const effective = [](optparse const& side, parameters const& option, std::optional<std::string_view> value)
+	{
+		if (!value && option.has_default)
+			value = side.default_(option);
+
+		return value;
+	};
+
+	auto const same = [](std::string_view x, std::string_view y)
+	{
+		for (size_t i = 0, j = 0; ; ++i, ++j)
+		{
+			while (i < x.size() && std::isspace(static_cast<unsigned char>(x[i]))) ++i;
+			while (j < y.size() && std::isspace(static_cast<unsigned char>(y[j]))) ++j;
+
+			if (i == x.size() || j == y.size())
+				return i == x.size() && j == y.size();
+
+			if (x[i] != y[j])
+				return false;
+		}
+	};
+
+	auto left = std::vector<entry> {};
+
+	a.for_each_option_([&](std::string_view key, parameters const& option, std::optional<std::string_view> value)
+	{
+		if (option.user_option)
+			left.push_back(entry { key, &option, value });
+	});
+
+	auto differences = std::vector<difference> {};
+
+	auto const removed = [&](entry const& l)
+	{
+		if (auto before = effective(a, *l.option, l.value); before || l.option->is_mutable)
+			differences.push_back(difference { difference::removed, std::string(l.key), a.current_(l.key, *l.option, before), "" });
+	};
+
+	auto i = size_t {0};
+
+	b.for_each_option_([&](std::string_view key, parameters const& option, std::optional<std::string_view> value)
+	{
+		if (!option.user_option)
+			return;
+
+		for (; i < left.size() && left[i].key < key; ++i)
+			removed(left[i]);
+
+		auto after = effective(b, option, value);
+
+		if (i == left.size() || left[i].key != key)
+		{
+			if (after || option.is_mutable)
+				differences.push_back(difference { difference::added, std::string(key), "", b.current_(key, option, after) });
+			return;
+		}
+
+		auto const& l = left[i++];
+
+		auto before = effective(a, *l.option, l.value);
+
+		if (l.option->is_mutable || option.is_mutable)
+		{
+			auto x = a.current_(key, *l.option, before);
+			auto y = b.current_(key, option, after);
+
+			if (!same(x, y))
+				differences.push_back(difference { difference::changed, std::string(key), std::move(x), std::move(y) });
+		}
+		else if (before && after)
+		{
+			if (!same(*before, *after))
+				differences.push_back(difference { difference::changed, std::string(key), std::string(*before), std::string(*after) });
+		}
+		else if (before)
+			differences.push_back(difference { difference::removed, std::string(key), std::string(*before), "" });
+
+		else if (after)
+			differences.push_back(difference { difference::added, std::string(key), "", std::string(*after) });
+	});
+
+	for (; i < left.size(); ++i)
+		removed(left[i]);
+
+	return differences;
+}
+
+auto
+optparse::tabulate(std::vector<std::string> const& pathnames) const -> table
+{
+	///	Every file is one row, read over the values of this object as layer() would, expressions
+	///	folded. The rows are built by a pool of threads, then each column gets the narrowest type
+	///	holding all of its cells: integers, else floating point (missing cells being NaN), else text.
+
+	auto names = std::vector<std::pair<std::string, uint32_t>> {};	// option, number of values
+
+	for_each_option_([&](std::string_view key, parameters const& option, std::optional<std::string_view>)
+	{
+		if (option.user_option)
+			names.emplace_back(key, std::max<uint32_t>(option.nargs, 1));
+	});
+
+	auto buffers = read_files_(pathnames);
+
+	auto cells = std::vector<std::vector<std::string>>(buffers.size());
+	auto errors = std::vector<std::exception_ptr>(buffers.size());
+
+	auto next = std::atomic<size_t> {0};
+
+	auto worker = [&]()
+	{
+		for (size_t r; (r = next.fetch_add(1, std::memory_order_relaxed)) < buffers.size(); )
+		{
+			try
+			{
+				auto row = *this;
+				auto read = std::map<std::string, std::string> {};
+
+				tokenize_(buffers[r], read);
+
+				for (auto& [key, value]: read)
+					row.overlay.insert_or_assign(key, std::move(value));
+
+				auto keys = std::vector<std::string> {};
+
+				for (auto const& [key, value]: read)
+					keys.push_back(key);
+
+				row.fold_expressions_(&keys);
+
+				for (auto const& [name, nargs]: names)
+				{
+					auto const text = row.find_number_(name).value_or(row.default_(*row.find_option_(name)));
+
+					for (uint32_t i = 0; i < nargs; ++i)
+					{
+						auto part = text;
+
+						for (uint32_t j = 0; j < i; ++j)
+							part = part.find(',') == part.npos ? std::string_view {} : part.substr(part.find(',') +1);
+
+						part = part.substr(0, part.find(','));
+
+						part.remove_prefix(std::min(part.find_first_not_of(' '), part.size()));
+						part = part.substr(0, part.find_last_not_of(' ') +1);
+
+						cells[r].emplace_back(part);
+					}
+				}
+				std::string().swap(buffers[r]);
+			}
+			catch (...)
+			{
+				errors[r] = std::current_exception();
+			}
+		}
+	};
+
+	auto const threads = std::min<size_t>({ buffers.size(), std::max(1u, std::thread::hardware_concurrency()), 64 });
+
+	auto pool = std::vector<std::thread>(threads > 1 ? threads -1 : 0);
+
+	for (auto& thread: pool)
+		thread = std::thread(worker);
+
+	worker();
+
+	for (auto& thread: pool)
+		thread.join();
+
+	for (auto const& error: errors)
+		if (error)
+			std::rethrow_exception(error);
+
+	auto result = table { .rows = pathnames, .columns = {} };
+
+	auto c = size_t {0};
+
+	for (auto const& [name, nargs]: names)
+	{
+		for (uint32_t i = 0; i < nargs; ++i, ++c)
+		{
+			auto const label = nargs > 1 ? name + "[" + std::to_string(i) + "]" : name;
+
+			auto integers = std::vector<int64_t> {};
+			auto reals = std::vector<double> {};
+
+			auto integral = true;
+			auto numeric = true;
+
+			for (auto const& row: cells)
+			{
+				auto const& cell = row[c];
+
+				auto integer = int64_t {0};
+				auto real = std::numeric_limits<double>::quiet_NaN();
+
+				auto const first = cell.data(), last = cell.data() + cell.size();
+
+				if (integral && (cell.empty() || std::from_chars(first, last, integer).ptr != last))
+					integral = false;
+
+				if (numeric && !cell.empty() && std::from_chars(first, last, real).ptr != last)
+					numeric = false;
+
+				if (!numeric)
+					break;
+
+				integers.push_back(integer);
+				reals.push_back(real);
+			}
+
+			if (numeric && integral)
+				result.columns.push_back(column { .name = label, .values = std::move(integers) });
+
+			else if (numeric)
+				result.columns.push_back(column { .name = label, .values = std::move(reals) });
+
+			else
+			{
+				auto texts = std::vector<std::string> {};
+
+				for (auto& row: cells)
+					texts.push_back(std::move(row[c]));
+
+				result.columns.push_back(column { .name = label, .values = std::move(texts) });
+			}
+		}
+	}
+	return result;
+}
+
+auto
+optparse::sample(sampling_t strategy, uint64_t k, uint64_t count, uint64_t seed) const -> optparse
+{
+	///	the k-th of count configurations over the 'low..high' values, computed directly from k
+
+	return sample_(ranges_(), strategy, k, count, seed);
+}
+
+auto
+optparse::shard(sampling_t strategy, uint64_t count, size_t worker, size_t workers, uint64_t seed) const -> std::vector<optparse>
+{
+	///	samples worker, worker + workers, ... of count, the same ones whoever computes them
+
+	if (workers == 0 || worker >= workers)
+		throw std::invalid_argument("optparse::shard: worker " + std::to_string(worker) + " out of " + std::to_string(workers));
+
+	auto const found = ranges_();
+
+	auto samples = std::vector<optparse> {};
+
+	for (auto k = uint64_t {worker}; k < count; k += workers)
+		samples.push_back(sample_(found, strategy, k, count, seed));
+
+	return samples;
+}
+
+auto
+optparse::ranges_() const -> std::vector<range>
+{
+	auto found = std::vector<range> {};
+
+	for_each_option_([&](std::string_view key, parameters const& option, std::optional<std::string_view> value)
+	{
+		if (!option.user_option || option.nargs != 1)
+			return;
+
+		auto text = value.value_or(default_(option));
+
+		text.remove_prefix(std::min(text.find_first_not_of(' '), text.size()));
+		text = text.substr(0, text.find_last_not_of(' ') +1);
+
+		auto const dots = text.find("..");
+
+		if (dots == text.npos)
+			return;
+
+		auto const low = text.substr(0, dots);
+		auto const high = text.substr(dots +2);
+
+		auto bounds = range { .name = std::string(key), .low = 0, .high = 0, .integral = true };
+
+		for (auto [end, bound]: { std::pair(low, &bounds.low), std::pair(high, &bounds.high) })
+		{
+			auto integer = int64_t {0};
+
+			if (std::from_chars(end.data(), end.data() + end.size(), integer).ptr != end.data() + end.size())
+				bounds.integral = false;
+
+			if (end.empty() || std::from_chars(end.data(), end.data() + end.size(), *bound).ptr != end.data() + end.size())
+				return;
+		}
+
+		if (bounds.low > bounds.high)
+			throw std::invalid_argument("optparse::sample: empty range for option " + bounds.name + ": " + std::string(text));
+
+		found.push_back(bounds);
+	});
+
+	return found;
+}
+
+auto
+optparse::sample_(std::vector<range> const& ranges, sampling_t strategy, uint64_t k, uint64_t count, uint64_t seed) const -> optparse
+{
+	if (strategy == latin_hypercube && (k >= count || count > std::numeric_limits<uint32_t>::max()))
+		throw std::invalid_argument("optparse::sample: a Latin hypercube needs k < count < 2^32");
+
+	if (strategy == sobol && (ranges.size() > 21 || k > std::numeric_limits<uint32_t>::max()))
+		throw std::invalid_argument("optparse::sample: Sobol points are available for up to 21 ranges and k < 2^32");
+
+	auto overrides = std::map<std::string, std::string> {};
+
+	for (uint32_t d = 0; d < ranges.size(); ++d)
+	{
+		auto const& r = ranges[d];
+
+		auto const u = unit_(strategy, k, count, d, seed);
+
+		if (r.integral)
+			overrides.emplace(r.name, std::to_string(static_cast<int64_t>(std::min(r.high, r.low + std::floor(u * (r.high - r.low + 1))))));
+		else
+		{
+			auto const value = r.low + u * (r.high - r.low);
+			overrides.emplace(r.name, format_<double>(&value));
+		}
+	}
+	return clone(overrides);
+}
+
+auto
+optparse::unit_(sampling_t strategy, uint64_t k, uint64_t count, uint32_t dimension, uint64_t seed) -> double
+{
+	///	coordinate dimension of sample k in [0, 1), a pure function of its arguments:
+	///		uniform_random	a counter-based hash of (seed, k, dimension)
+	///		latin_hypercube	the stratum of k in a hash-keyed permutation of count, jittered
+	///		sobol			the k-th Sobol point (Gray code order), digitally shifted by the seed
+
+	auto const stream = mix_(mix_(seed) ^ dimension);
+
+	switch (strategy)
+	{
+		case latin_hypercube:
+		{
+			auto const stratum = permute_(static_cast<uint32_t>(k), static_cast<uint32_t>(count), static_cast<uint32_t>(stream));
+			auto const jitter = (mix_(stream ^ k) >> 11) * 0x1.0p-53;
+
+			return (stratum + jitter) / count;
+		}
+		case sobol:
+		{
+			auto const shift = seed ? static_cast<uint32_t>(stream >> 32) : 0;
+
+			return (sobol_(k, dimension) ^ shift) * 0x1.0p-32;
+		}
+		default:
+			return (mix_(stream ^ mix_(k)) >> 11) * 0x1.0p-53;
+	}
+}
+
+auto
+optparse::mix_(uint64_t x) -> uint64_t
+{
+	///	the splitmix64 finalizer
+
+	x += 0x9e3779b97f4a7c15ull;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+
+	return x ^ (x >> 31);
+}
+
+auto
+optparse::permute_(uint32_t i, uint32_t l, uint32_t p) -> uint32_t
+{
+	///	Kensler's hashed permutation of [0, l) keyed by p (Correlated Multi-Jittered Sampling, 2013):
+	///	a bijection on the enclosing power of two, walked until it lands inside [0, l)
+
+	auto w = l - 1;
+
+	w |= w >> 1;
+	w |= w >> 2;
+	w |= w >> 4;
+	w |= w >> 8;
+	w |= w >> 16;
+
+	do
+	{
+		i ^= p;
+		i *= 0xe170893d;
+		i ^= p >> 16;
+		i ^= (i & w) >> 4;
+		i ^= p >> 8;
+		i *= 0x0929eb3f;
+		i ^= p >> 23;
+		i ^= (i & w) >> 1;
+		i *= 1 | p >> 27;
+		i *= 0x6935fa69;
+		i ^= (i & w) >> 11;
+		i *= 0x74dcb303;
+		i ^= (i & w) >> 2;
+		i *= 0x9e501cc3;
+		i ^= (i & w) >> 2;
+		i *= 0xc860a3df;
+		i &= w;
+		i ^= i >> 5;
+	}
+	while (i >= l);
+
+	return (i + p) % l;
+}
+
+auto
+optparse::sobol_(uint64_t k, uint32_t dimension) -> uint32_t
+{
+	///	Direction numbers of Joe and Kuo (new-joe-kuo-6.21201) for dimensions 2 to 21, as
+	///	(degree s, coefficients a, initial m_1 ... m_s); the first dimension is van der Corput
+
+	static constexpr struct { uint32_t s; uint32_t a; uint32_t m[7]; } polynomials[20] = {
+		{ 1,  0, { 1 } },
+		{ 2,  1, { 1, 3 } },
+		{ 3,  1, { 1, 3, 1 } },
+		{ 3,  2, { 1, 1, 1 } },
+		{ 4,  1, { 1, 1, 3, 3 } },
+		{ 4,  4, { 1, 3, 5, 13 } },
+		{ 5,  2, { 1, 1, 5, 5, 17 } },
+		{ 5,  4, { 1, 1, 5, 5, 5 } },
+		{ 5,  7, { 1, 1, 7, 11, 19 } },
+		{ 5, 11, { 1, 1, 5, 1, 1 } },
+		{ 5, 13, { 1, 1, 1, 3, 11 } },
+		{ 5, 14, { 1, 3, 5, 5, 31 } },
+		{ 6,  1, { 1, 3, 3, 9, 7, 49 } },
+		{ 6, 13, { 1, 1, 1, 15, 21, 21 } },
+		{ 6, 16, { 1, 3, 1, 13, 27, 49 } },
+		{ 6, 19, { 1, 1, 1, 15, 7, 5 } },
+		{ 6, 22, { 1, 3, 1, 15, 13, 25 } },
+		{ 6, 25, { 1, 1, 5, 5, 19, 61 } },
+		{ 7,  1, { 1, 3, 7, 11, 23, 15, 103 } },
+		{ 7,  4, { 1, 3, 7, 13, 13, 15, 69 } },
+	};
+
+	static auto const directions = []()
+	{
+		auto v = std::array<std::array<uint32_t, 32>, 21> {};
+
+		for (uint32_t j = 0; j < 32; ++j)
+			v[0][j] = uint32_t {1} << (31 - j);
+
+		for (uint32_t d = 1; d < 21; ++d)
+		{
+			auto const& [s, a, m] = polynomials[d - 1];
+
+			for (uint32_t j = 0; j < 32; ++j)
+			{
+				if (j < s)
+				{
+					v[d][j] = m[j] << (31 - j);
+					continue;
+				}
+
+				v[d][j] = v[d][j - s] ^ (v[d][j - s] >> s);
+
+				for (uint32_t i = 1; i < s; ++i)
+					if ((a >> (s - 1 - i)) & 1)
+						v[d][j] ^= v[d][j - i];
+			}
+		}
+		return v;
+	}();
+
+	auto x = uint32_t {0};
+
+	for (auto gray = k ^ (k >> 1), j = uint64_t {0}; gray; gray >>= 1, ++j)
+		if (gray & 1)
+			x ^= directions[dimension][j];
+
+	return x;
+}
+
+template <typename T>
+auto
+optparse::difference::as() const -> std::pair<T, T>
+{
+	auto converted = std::pair(T {}, T {});
+
+	if (!before.empty() && !(std::stringstream(before) >> converted.first))
+		throw std::runtime_error("Invalid conversion of the argument '" + before + "' to type " + typeid(T).name());
+
+	if (!after.empty() && !(std::stringstream(after) >> converted.second))
+		throw std::runtime_error("Invalid conversion of the argument '" + after + "' to type " + typeid(T).name());
+
+	return converted;
+}
+
+auto
+optparse::fingerprint() const -> digest
+{
+	///	The sum of a 128-bit hash of every (name, value) pair, defaults included, so that the
+	///	order in which options were given doesn't matter and a change only moves its own term
+
+	auto sum = digest {};
+
+	runtime.fingerprint.load(&sum, sizeof(sum));
+
+	return sum;
+}
+
+auto
+optparse::entry_digest_(std::string_view key, parameters const& option, std::optional<std::string_view> value) const -> digest
+{
+	///	the text as written, which determines the folded result of an expression, spaces don't
+	///	count; the contents of a mapped array stand for the size and modification time of its file
+
+	auto text = current_(key, option, value);
+
+	text.erase(std::remove_if(text.begin(), text.end(), isspace), text.end());
+
+	if (auto const index = find_array_(std::string(key)); index < arrays->size())
+		text.append(1, '\0').append((*arrays)[index].stamp);
+
+	return hash128_(key, text);
+}
+
+auto
+optparse::hash128_(std::string_view key, std::string_view text) -> digest
+{
+	///	MurmurHash3 x64 128 of key '\0' text, words read as little endian on every host
+
+	auto bytes = std::string(key);
+
+	bytes += '\0';
+	bytes += text;
+
+	auto const word = [&bytes](size_t at, size_t count)
+	{
+		auto w = uint64_t {0};
+
+		for (size_t i = count; i-- > 0; )
+			w = w << 8 | static_cast<unsigned char>(bytes[at + i]);
+
+		return w;
+	};
+
+	auto const fmix = [](uint64_t k)
+	{
+		k ^= k >> 33;
+		k *= 0xff51afd7ed558ccdull;
+		k ^= k >> 33;
+		k *= 0xc4ceb9fe1a85ec53ull;
+		k ^= k >> 33;
+
+		return k;
+	};
+
+	auto constexpr c1 = 0x87c37b91114253d5ull;
+	auto constexpr c2 = 0x4cf5ad432745937full;
+
+	auto h1 = uint64_t {0};
+	auto h2 = uint64_t {0};
+
+	auto const blocks = bytes.size() / 16;
+
+	for (size_t i = 0; i < blocks; ++i)
+	{
+		auto k1 = word(16 * i, 8);
+		auto k2 = word(16 * i + 8, 8);
+
+		k1 *= c1; k1 = std::rotl(k1, 31); k1 *= c2; h1 ^= k1;
+		h1 = std::rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+		k2 *= c2; k2 = std::rotl(k2, 33); k2 *= c1; h2 ^= k2;
+		h2 = std::rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+	}
+
+	auto const tail = bytes.size() % 16;
+
+	if (tail > 8)
+	{
+		auto k2 = word(16 * blocks + 8, tail - 8);
+		k2 *= c2; k2 = std::rotl(k2, 33); k2 *= c1; h2 ^= k2;
+	}
+
+	if (tail > 0)
+	{
+		auto k1 = word(16 * blocks, std::min<size_t>(tail, 8));
+		k1 *= c1; k1 = std::rotl(k1, 31); k1 *= c2; h1 ^= k1;
+	}
+
+	h1 ^= bytes.size();
+	h2 ^= bytes.size();
+
+	h1 += h2;
+	h2 += h1;
+
+	h1 = fmix(h1);
+	h2 = fmix(h2);
+
+	h1 += h2;
+	h2 += h1;
+
+	return digest { .high = h2, .low = h1 };
+}
+
+auto
+optparse::combine_(digest sum, digest entry, bool remove) -> digest
+{
+	///	addition (or subtraction) modulo 2^128
+
+	if (remove)
+	{
+		auto const borrow = sum.low < entry.low;
+
+		return digest { .high = sum.high - entry.high - borrow, .low = sum.low - entry.low };
+	}
+
+	auto const low = sum.low + entry.low;
+
+	return digest { .high = sum.high + entry.high + (low < sum.low), .low = low };
+}
+
+auto
+optparse::find_number_(std::string const& name) const -> std::optional<std::string_view>
+{
+	if (auto value = folded->find(name); value != folded->end())
+		return value->second;
+
+	return find_value_(name);
+}
+
+void
+optparse::fold_expressions_(std::vector<std::string> const* overridden)
+{
+	///	The values of expression options, such as '1/1024' or '2.5*sigma', are compiled once every
+	///	layer is merged, then folded depth-first so that the options referred to come first. Each
+	///	component must be a number or an expression over numbers and numeric options. Integers
+	///	are computed exactly while the result is an integer fitting in 64 bits, the rest in double.
+	///	After clone() only the overridden options and the expressions referring to them, however
+	///	indirectly, are compiled and folded again; the other results are kept.
+
+	struct operand {
+		bool exact;	// integer holds the value
+		int64_t integer;
+		double real;
+	};
+
+	auto const exact = [](int64_t integer) { return operand { .exact = true, .integer = integer, .real = static_cast<double>(integer) }; };
+	auto const inexact = [](double real) { return operand { .exact = false, .integer = 0, .real = real }; };
+
+	auto programs = std::map<std::string, std::vector<std::vector<instruction>>> {};
+
+	auto const component = [](std::string_view text, size_t i)
+	{
+		for (; i > 0; --i)
+			text.remove_prefix(text.find(',') +1);
+
+		return text.substr(0, text.find(','));
+	};
+
+	auto const literal = [&](std::string_view text, operand& number)
+	{
+		while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+		while (!text.empty() && text.back() == ' ') text.remove_suffix(1);
+
+		auto const end = text.data() + text.size();
+
+		auto integer = int64_t {0};
+
+		if (auto [next, error] = std::from_chars(text.data(), end, integer); error == std::errc {} && next == end)
+		{
+			number = exact(integer);
+			return true;
+		}
+
+		auto real = 0.0;
+
+		auto [next, error] = std::from_chars(text.data(), end, real);
+
+		number = inexact(real);
+
+		return error == std::errc {} && next == end;
+	};
+
+	auto const compile = [&](std::string_view key, parameters const& option, std::optional<std::string_view> value)
+	{
+		auto const text = value.value_or(default_(option));
+
+		if (!option.is_expression || option.nargs == 0 || text.empty())
+			return;
+
+		auto compiled = std::vector<std::vector<instruction>>(std::count(text.begin(), text.end(), ',') +1);
+
+		auto expressions = 0;
+
+		for (size_t i = 0; i < compiled.size(); ++i)
+		{
+			auto const part = component(text, i);
+
+			auto number = operand {};
+
+			if (literal(part, number))
+				continue;
+
+			auto at = size_t {0};
+
+			if (!compile_(part, at, 1, compiled[i]) || at != part.size())
+			{
+				while (at < part.size() && part[at] == ' ')
+					++at;
+
+				auto const name = std::string(part.substr(at, std::find_if_not(part.begin() + at, part.end(), [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }) - part.begin() - at));
+
+				if (!name.empty() && !std::isdigit(static_cast<unsigned char>(name[0])))
+					if (auto referred = find_option_(name); !referred || !referred->user_option || referred->nargs == 0)
+						throw std::invalid_argument("optparse::parse: value of option " + std::string(key) + " refers to unknown or non-numeric option: " + name);
+
+				throw std::invalid_argument("optparse::parse: value of option " + std::string(key) + " is not an arithmetic expression: " + std::string(part));
+			}
+
+			++expressions;
+		}
+
+		if (expressions)
+			programs.emplace(key, std::move(compiled));
+	};
+
+	/// The options to fold again: the overridden ones, then whatever refers to one of them
+
+	auto dirty = std::vector<std::string> {};	// sorted
+
+	auto const is_dirty = [&dirty](std::string const& name) { return std::binary_search(dirty.begin(), dirty.end(), name); };
+
+	if (overridden)
+	{
+		for (auto pending = *overridden; !pending.empty(); )
+		{
+			auto name = std::move(pending.back());
+			pending.pop_back();
+
+			if (auto at = std::lower_bound(dirty.begin(), dirty.end(), name); at == dirty.end() || *at != name)
+			{
+				if (auto referrer = referrers->find(name); referrer != referrers->end())
+					pending.insert(pending.end(), referrer->second.begin(), referrer->second.end());
+
+				dirty.insert(at, std::move(name));
+			}
+		}
+
+		for (auto const& name: dirty)
+			compile(name, *find_option_(name), find_value_(name));
+
+		if (programs.empty() && std::none_of(dirty.begin(), dirty.end(), [this](auto const& name) { return folded->count(name); }))
+			return;
+	}
+	else
+		for_each_option_(compile);
+
+	auto results = std::map<std::string, operand> {};
+	auto visiting = std::vector<std::string> {};
+
+	std::function<operand(std::vector<instruction> const&)> evaluate;
+
+	auto const resolve = [&](std::string const& name) -> operand
+	{
+		if (auto result = results.find(name); result != results.end())
+			return result->second;
+
+		if (std::find(visiting.begin(), visiting.end(), name) != visiting.end())
+			throw std::invalid_argument("optparse::parse: circular reference in the value of option: " + name);
+
+		auto const referrer = visiting.empty() ? name : visiting.back();
+
+		auto number = operand {};
+
+		auto const kept = overridden && !is_dirty(name) ? folded->find(name) : folded->end();	// still valid
+
+		if (auto program = programs.find(name); program != programs.end())
+		{
+			if (program->second.size() != 1)
+				throw std::invalid_argument("optparse::parse: value of option " + referrer + " refers to option with several values: " + name);
+
+			visiting.push_back(name);
+			number = evaluate(program->second[0]);
+			visiting.pop_back();
+		}
+		else if (kept != folded->end())
+		{
+			if (kept->second.find(',') != std::string::npos)
+				throw std::invalid_argument("optparse::parse: value of option " + referrer + " refers to option with several values: " + name);
+
+			literal(kept->second, number);
+		}
+		else if (!literal(find_value_(name).value_or(default_(*find_option_(name))), number))
+			throw std::invalid_argument("optparse::parse: value of option " + referrer + " refers to non-numeric option: " + name);
+
+		return results[name] = number;
+	};
+
+	auto const apply = [&](char op, operand a, operand b) -> operand
+	{
+		auto r = int64_t {0};
+
+		if (a.exact && b.exact)
+		{
+			switch (op)
+			{
+				case '+': if (!__builtin_add_overflow(a.integer, b.integer, &r)) return exact(r); break;
+				case '-': if (!__builtin_sub_overflow(a.integer, b.integer, &r)) return exact(r); break;
+				case '*': if (!__builtin_mul_overflow(a.integer, b.integer, &r)) return exact(r); break;
+				case '/':
+					if (b.integer != 0 && (b.integer != -1 || a.integer != INT64_MIN) && a.integer % b.integer == 0)
+						return exact(a.integer / b.integer);
+					break;
+				case '^':
+				{
+					auto base = a.integer;
+					auto overflow = b.integer < 0;	// a fraction
+
+					r = 1;
+
+					for (auto power = b.integer; power > 0 && !overflow; power >>= 1)
+					{
+						if (power & 1)
+							overflow |= __builtin_mul_overflow(r, base, &r);
+
+						if (power > 1)
+							overflow |= __builtin_mul_overflow(base, base, &base);
+					}
+					if (!overflow)
+						return exact(r);
+					break;
+				}
+			}
+		}
+
+		switch (op)
+		{
+			case '+': return inexact(a.real + b.real);
+			case '-': return inexact(a.real - b.real);
+			case '*': return inexact(a.real * b.real);
+			case '/': return inexact(a.real / b.real);
+			default: return inexact(std::pow(a.real, b.real));
+		}
+	};
+
+	evaluate = [&](std::vector<instruction> const& program) -> operand
+	{
+		auto stack = std::vector<operand> {};
+
+		for (auto const& i: program)
+		{
+			if (i.op == 'n' || i.op == 'i' || i.op == 'r')
+			{
+				stack.push_back(i.op == 'n' ? inexact(i.number) : i.op == 'i' ? exact(i.integer) : resolve(i.name));
+				continue;
+			}
+
+			if (i.op == '~')
+			{
+				auto& a = stack.back();
+
+				a = (a.exact && a.integer != INT64_MIN) ? exact(-a.integer) : inexact(-a.real);
+				continue;
+			}
+
+			auto const b = stack.back();
+			stack.pop_back();
+
+			stack.back() = apply(i.op, stack.back(), b);
+		}
+		return stack.back();
+	};
+
+	///	integers as such, the rest in fixed notation: '1e+17' would read as 1 through an integer
+
+	auto const text_of = [](operand number)
+	{
+		if (number.exact)
+			return std::to_string(number.integer);
+
+		char buffer[512];	// the longest fixed double, the smallest subnormal, takes some 330
+
+		auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), number.real, std::chars_format::fixed);
+
+		return std::string(buffer, end);
+	};
+
+	auto constants = overridden ? *folded : std::map<std::string, std::string> {};
+
+	for (auto const& name: dirty)
+		constants.erase(name);
+
+	for (auto const& [key, compiled]: programs)
+	{
+		auto const text = find_value_(key).value_or(default_(*find_option_(key)));
+
+		auto joined = std::string {};
+
+		for (size_t i = 0; i < compiled.size(); ++i)
+		{
+			auto part = std::string(component(text, i));
+
+			if (!compiled[i].empty())
+			{
+				visiting.clear();
+
+				if (compiled.size() > 1)
+					visiting.push_back(key);
+
+				auto const number = compiled.size() == 1 ? resolve(key) : evaluate(compiled[i]);
+
+				part = text_of(number);
+			}
+			joined += (i ? ", " : "") + part;
+		}
+		constants.emplace(key, joined);
+	}
+
+	folded = std::make_shared<std::map<std::string, std::string>>(std::move(constants));
+
+	/// Who refers to whom, for the next clone(); after one, edges are only added
+
+	if (!overridden)
+		referrers = std::make_shared<std::map<std::string, std::vector<std::string>>>();
+
+	for (auto const& [key, compiled]: programs)
+	{
+		for (auto const& program: compiled)
+		{
+			for (auto const& i: program)
+			{
+				if (i.op != 'r')
+					continue;
+
+				if (auto names = referrers->find(i.name); names == referrers->end() || std::find(names->second.begin(), names->second.end(), key) == names->second.end())
+					detach_(referrers)[i.name].push_back(key);
+			}
+		}
+	}
+}
+
+auto
+optparse::compile_(std::string_view text, size_t& at, int precedence, std::vector<instruction>& program) const -> bool
+{
+	///	precedence climbing: an operand, then every operator binding at least as tightly as
+	///	precedence; '^' is right associative and binds tighter than a unary sign
+
+	auto const skip = [&]()
+	{
+		while (at < text.size() && text[at] == ' ')
+			++at;
+	};
+
+	skip();
+
+	if (at == text.size())
+		return false;
+
+	if (text[at] == '(')
+	{
+		++at;
+
+		if (!compile_(text, at, 1, program))
+			return false;
+
+		skip();
+
+		if (at == text.size() || text[at++] != ')')
+			return false;
+	}
+	else if (text[at] == '-' || text[at] == '+')
+	{
+		auto const sign = text[at++];
+
+		if (!compile_(text, at, 3, program))
+			return false;
+
+		if (sign == '-')
+			program.push_back(instruction { .op = '~', .number = 0, .integer = 0, .name = {} });
+	}
+	else if (std::isalpha(static_cast<unsigned char>(text[at])) || text[at] == '_')
+	{
+		auto const first = at;
+
+		while (at < text.size() && (std::isalnum(static_cast<unsigned char>(text[at])) || text[at] == '_'))
+			++at;
+
+		auto name = std::string(text.substr(first, at - first));
+
+		if (auto option = find_option_(name); !option || !option->user_option || option->nargs == 0)
+		{
+			at = first;	// the caller names it
+			return false;
+		}
+
+		program.push_back(instruction { .op = 'r', .number = 0, .integer = 0, .name = std::move(name) });
+	}
+	else
+	{
+		auto number = 0.0;
+		auto integer = int64_t {0};
+
+		auto [next, error] = std::from_chars(text.data() + at, text.data() + text.size(), number);
+		auto [last, failed] = std::from_chars(text.data() + at, text.data() + text.size(), integer);
+
+		if (error != std::errc {})
+			return false;
+
+		at = next - text.data();
+
+		if (failed == std::errc {} && last == next)
+			program.push_back(instruction { .op = 'i', .number = number, .integer = integer, .name = {} });
+		else
+			program.push_back(instruction { .op = 'n', .number = number, .integer = 0, .name = {} });
+	}
+
+	for (;;)
+	{
+		skip();
+
+		if (at == text.size())
+			return true;
+
+		auto const op = text[at];
+		auto const level = (op == '+' || op == '-') ? 1 : (op == '*' || op == '/') ? 2 : (op == '^') ? 3 : 0;
+
+		if (level == 0 || level < precedence)
+			return true;
+
+		++at;
+
+		if (!compile_(text, at, op == '^' ? level : level +1, program))
+			return false;
+
+		program.push_back(instruction { .op = op, .number = 0, .integer = 0, .name = {} });
+	}
+}
+
+auto
+optparse::find_value_(std::string const& name) const -> std::optional<std::string_view>
+{
+	if (auto value = overlay.find(name); value != overlay.end())
+		return value->second;
+
+	if (!frozen)
+	{
+		if (auto value = values->find(name); value != values->end())
+			return value->second;
+
+		return std::nullopt;
+	}
+
+	if (auto k = find_entry_(name); k && frozen->table[k].has_value)
+		return std::string_view(frozen->blob).substr(frozen->table[k].key + frozen->table[k].key_size, frozen->table[k].value_size);
+
+	return std::nullopt;
+}
+
+template <typename F>
+void
+optparse::for_each_option_(F&& f) const
+{
+	/// Calls f(name, parameters, value) in name order, the value being the one found by
+	///	find_value_(); the sorted layers are walked side by side
+
+	auto over = overlay.begin();
+
+	auto const visit = [&](std::string_view key, parameters const& option, std::optional<std::string_view> value)
+	{
+		while (over != overlay.end() && over->first < key)
+			++over;
+
+		if (over != overlay.end() && over->first == key)
+			value = over->second;
+
+		f(key, option, value);
+	};
+
+	if (!frozen)
+	{
+		auto value = values->begin();
+
+		for (auto const& option: *options)
+		{
+			while (value != values->end() && value->first < option.first)
+				++value;
+
+			if (value != values->end() && value->first == option.first)
+				visit(option.first, option.second, value->second);
+			else
+				visit(option.first, option.second, std::nullopt);
+		}
+		return;
+	}
+
+	/// In-order traversal of the Eytzinger layout: leftmost node first, then the successor
+	///	is the leftmost node of the right subtree, or the first ancestor reached from the left
+
+	auto const& table = frozen->table;
+	auto const n = table.size() - 1;
+
+	auto k = size_t {1};
+
+	while (2 * k <= n)
+		k *= 2;
+
+	while (n && k)
+	{
+		auto const& entry = table[k];
+		auto const key = std::string_view(frozen->blob).substr(entry.key, entry.key_size);
+
+		visit(key, frozen->options[k], entry.has_value ? std::optional(std::string_view(frozen->blob).substr(entry.key + entry.key_size, entry.value_size)) : std::nullopt);
+
+		if (2 * k + 1 <= n)
+			for (k = 2 * k + 1; 2 * k <= n; k *= 2);
+		else
+			k >>= std::countr_one(k) + 1;
+	}
+}
+
+
+auto
+optparse::compile_group_(std::vector<std::string> const& names) const -> std::vector<std::pair<size_t, uint64_t>>
+{
+	///	one (word, bits) pair per 64-bit word holding a member, in word order
+
+	auto masks = std::vector<std::pair<size_t, uint64_t>> {};
+
+	for (auto const& name: names)
+	{
+		auto option = find_option_(name);
+
+		if (!option)
+			throw std::invalid_argument("optparse::insert_option: group of an unknown option: " + name + did_you_mean_(name));
+
+		auto const [word, bit] = std::pair(option->index / 64, uint64_t {1} << (option->index % 64));
+
+		if (auto mask = std::find_if(masks.begin(), masks.end(), [word](auto const& m) { return m.first == word; }); mask != masks.end())
+			mask->second |= bit;
+		else
+			masks.emplace_back(word, bit);
+	}
+	std::sort(masks.begin(), masks.end());
+
+	return masks;
+}
+
+void
+optparse::validate_groups_(std::vector<std::pair<size_t, uint64_t>> const* overridden) const
+{
+	if (constraints->empty())
+		return;
+
+	auto const bits = [](std::vector<std::pair<size_t, uint64_t>> const& masks, size_t word)
+	{
+		auto mask = std::lower_bound(masks.begin(), masks.end(), std::pair(word, uint64_t {0}));
+
+		return (mask != masks.end() && mask->first == word) ? mask->second : uint64_t {0};
+	};
+
+	/// (word, bits) of the options given by command line, configuration file or clone(), defaults
+	///	aren't counted. After clone() only the groups of an overridden option are checked, and only
+	///	their members are looked up
+
+	auto set = std::vector<std::pair<size_t, uint64_t>> {};
+
+	if (!overridden)
+	{
+		auto dense = std::vector<uint64_t> {};
+
+		for_each_option_([&dense](std::string_view, parameters const& option, std::optional<std::string_view> value)
+		{
+			if (dense.size() <= option.index / 64)
+				dense.resize(option.index / 64 + 1);
+
+			if (value)
+				dense[option.index / 64] |= uint64_t {1} << (option.index % 64);
+		});
+
+		for (size_t word = 0; word < dense.size(); ++word)
+			if (dense[word])
+				set.emplace_back(word, dense[word]);
+	}
+
+	for (auto const& group: *constraints)
+	{
+		if (overridden)
+		{
+			auto touched = bits(*overridden, group.dependent.first) & group.dependent.second;
+
+			for (auto const& [word, mask]: group.masks)
+				touched |= bits(*overridden, word) & mask;
+
+			if (!touched)
+				continue;
+
+			auto given = std::vector<std::string> {};
+
+			for (auto const& member: group.members)
+				if (find_value_(member))
+					given.push_back(member);
+
+			set = compile_group_(given);
+		}
+
+		if (group.exclusive)
+		{
+			auto count = 0;
+
+			for (auto const& [word, mask]: group.masks)
+				count += std::popcount(bits(set, word) & mask);
+
+			if (count > 1)
+				throw std::invalid_argument("optparse::parse: options are mutually exclusive: " + group.names);
+
+			if (count == 0 && group.required)
+				throw std::invalid_argument("optparse::parse: exactly one option is required among: " + group.names);
+		}
+		else if (bits(set, group.dependent.first) & group.dependent.second)
+		{
+			for (auto const& [word, mask]: group.masks)
+				if ((bits(set, word) & mask) != mask)
+					throw std::invalid_argument("optparse::parse: dependency not satisfied, option " + group.names);
+		}
+	}
+}
+
+void
+optparse::convert_hot_()
+{
+	if (hot_fields->empty())
+		return;
+
+	/// A block of its own, whole cache lines, so that no line is shared with data being written
+
+	auto const size = (hot_size + 63) / 64 * 64;
+
+	auto block = std::shared_ptr<void>(::operator new(size, std::align_val_t {64}),
+			[](void* p) { ::operator delete(p, std::align_val_t {64}); });
+
+	std::memset(block.get(), 0, size);
+
+	for (auto const& field: *hot_fields)
+		field.convert(*this, field.name, static_cast<std::byte*>(block.get()) + field.offset);
+
+	hot_block = block;
+}
+
+template <typename T>
+void
+optparse::convert_(optparse const& self, std::string const& name, void* destination)
+{
+	auto const value = self.retrieve<T>(name);
+
+	std::memcpy(destination, &value, sizeof(T));
+}
+
+void
+optparse::convert_runtime_()
+{
+	if (runtime_fields->empty())
+		return;
+
+	auto const guard = std::lock_guard(runtime.writer);
+
+	runtime.slots.clear();
+
+	for (auto const& field: *runtime_fields)
+	{
+		auto const option = find_option_(field.name);
+		auto const text = find_number_(field.name).value_or(default_(*option));
+
+		seqlock_slot::words_t converted {};
+
+		if (text.length())
+			field.convert(text, &converted);
+
+		runtime.slots.emplace_back().store(&converted, field.size);
+	}
+}
+
+auto
+optparse::insert_option_schedule(std::string name, std::string description, std::string default_value) -> schedule
+{
+	insert_option(name, 1, description, default_value);
+
+	detach_(schedule_fields).push_back(name);
+
+	return schedule { .index = static_cast<uint32_t>(schedule_fields->size() - 1) };
+}
+
+void
+optparse::insert_option_expression(std::string name, size_t nargs, std::string description, std::string default_value)
+{
+	insert_option(name, nargs, description, default_value);
+
+	schema_().at(name).is_expression = true;
+}
+
+auto
+optparse::retrieve_at(schedule option, double step) const -> double
+{
+	auto const& compiled = (*schedules)[option.index];
+
+	auto const x = std::clamp(step, compiled.first, compiled.last);
+
+	auto k = std::min(static_cast<size_t>((x - compiled.first) * compiled.scale), compiled.buckets.size() - 1);
+
+	auto i = compiled.buckets[k];
+
+	while (x >= compiled.segments[i].next)
+		++i;
+
+	return compiled.segments[i].a + compiled.segments[i].b * x;
+}
+
+void
+optparse::compile_schedules_()
+{
+	if (schedule_fields->empty())
+		return;
+
+	auto compiled = std::make_shared<std::vector<compiled_schedule>>();
+
+	for (auto const& name: *schedule_fields)
+		compiled->push_back(compile_schedule_(name, find_value_(name).value_or(default_(*find_option_(name)))));
+
+	schedules = compiled;
+}
+
+auto
+optparse::find_schedule_(std::string const& name) const -> size_t
+{
+	auto field = std::find(schedule_fields->begin(), schedule_fields->end(), name);
+
+	return static_cast<size_t>(field - schedule_fields->begin());
+}
+
+auto
+optparse::compile_schedule_(std::string const& name, std::string_view text) -> compiled_schedule
+{
+	///	'value@step' points with increasing steps, separated by commas, then optionally 'linear'
+	///	(the default) or 'step'; before the first point and after the last the value is held
+
+	auto const invalid = [&]()
+	{
+		return std::invalid_argument("optparse::parse: invalid schedule for option " + name + ": '" + std::string(text) + \
+				"', expected 'value@step, value@step, ... [linear|step]'");
+	};
+
+	auto points = std::vector<std::pair<double, double>> {};	// (step, value)
+	auto linear = true;
+
+	for (auto first = text.data(), last = text.data() + text.size(); first < last; ++first)
+	{
+		auto const skip = [&]()
+		{
+			while (first < last && *first == ' ')
+				++first;
+		};
+
+		auto value = 0.0;
+		auto step = 0.0;
+
+		skip();
+
+		auto parsed = std::from_chars(first, last, value);
+
+		if (parsed.ec != std::errc {} || parsed.ptr == last || *parsed.ptr != '@')
+			throw invalid();
+
+		parsed = std::from_chars(parsed.ptr +1, last, step);
+
+		if (parsed.ec != std::errc {} || (!points.empty() && step <= points.back().first))
+			throw invalid();
+
+		points.emplace_back(step, value);
+
+		first = parsed.ptr;
+		skip();
+
+		if (first < last && *first != ',')
+		{
+			auto mode = std::string_view(first, last - first);
+
+			mode = mode.substr(0, mode.find_last_not_of(' ') +1);
+
+			if (mode != "linear" && mode != "step")
+				throw invalid();
+
+			linear = mode == "linear";
+
+			break;
+		}
+	}
+
+	if (points.empty())
+		throw invalid();
+
+	auto compiled = compiled_schedule {};
+
+	compiled.first = points.front().first;
+	compiled.last = points.back().first;
+
+	auto gap = std::numeric_limits<double>::infinity();
+
+	for (size_t j = 0; j + 1 < points.size(); ++j)
+	{
+		auto const [t0, v0] = points[j];
+		auto const [t1, v1] = points[j +1];
+
+		auto const b = linear ? (v1 - v0) / (t1 - t0) : 0.0;
+
+		compiled.segments.push_back(segment { .a = v0 - b * t0, .b = b, .next = t1 });
+
+		gap = std::min(gap, t1 - t0);
+	}
+	compiled.segments.push_back(segment { .a = points.back().second, .b = 0.0, .next = std::numeric_limits<double>::infinity() });
+
+	///	one bucket per shortest segment, so that a bucket holds a single breakpoint at most, up to
+	///	64 buckets per segment; past that a lookup may step over a few segments. Buckets start a
+	///	hair early, a step rounded into the next bucket must not skip its segment.
+
+	auto const range = compiled.last - compiled.first;
+
+	auto const count = range > 0 ? static_cast<size_t>(std::min(std::ceil(range / gap), 64.0 * compiled.segments.size())) : size_t {1};
+
+	compiled.scale = range > 0 ? count / range : 0.0;
+
+	compiled.buckets.resize(count);
+
+	for (size_t k = 0, i = 0; k < count; ++k)
+	{
+		auto const start = compiled.first + range * (k - 1e-6) / count;
+
+		while (start >= compiled.segments[i].next)
+			++i;
+
+		compiled.buckets[k] = static_cast<uint32_t>(i);
+	}
+	return compiled;
+}
+
+void
+optparse::map_arrays_()
+{
+	if (array_fields->empty())
+		return;
+
+	auto mapped = std::make_shared<std::vector<mapped_array>>();
+
+	for (auto const& field: *array_fields)
+	{
+		auto const text = find_value_(field.name).value_or("");
+
+		if (text.empty() || text[0] != '@')
+			throw std::invalid_argument("optparse::parse: array option expects an '@file' value: " + field.name);
+
+		mapped->push_back(map_array_(field, std::string(text.substr(1))));
+	}
+	arrays = mapped;
+}
+
+auto
+optparse::find_array_(std::string const& name) const -> size_t
+{
+	auto field = std::find_if(array_fields->begin(), array_fields->end(), [&name](auto const& f) { return f.name == name; });
+
+	return static_cast<size_t>(field - array_fields->begin());
+}
+
+auto
+optparse::map_array_(array_field const& field, std::string const& pathname) -> mapped_array
+{
+	///	The whole file is mapped (or read, without mmap) and the array is an aliasing pointer into it.
+	///	A .npy file is recognized by its magic string, its header is checked against the declaration.
+
+	auto const failed = std::runtime_error("optparse::parse: opening file '" + pathname + \
+			"' failed, it either doesn't exist or is not accessible.");
+
+	auto mapping = std::shared_ptr<const void> {};
+	auto size = size_t {0};
+
+#ifdef OPTPARSE_POSIX
+	auto fd = ::open(pathname.c_str(), O_RDONLY | O_CLOEXEC);
+
+	struct stat status;
+
+	if (fd < 0 || ::fstat(fd, &status) != 0)
+	{
+		if (fd >= 0)
+			::close(fd);
+		throw failed;
+	}
+	size = status.st_size;
+
+	if (size)
+	{
+		auto base = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (base == MAP_FAILED)
+		{
+			::close(fd);
+			throw failed;
+		}
+		mapping = std::shared_ptr<const void>(base, [size](void const* p) { ::munmap(const_cast<void*>(p), size); });
+	}
+	::close(fd);
+#else
+	std::ifstream file(pathname, std::ios::binary);
+
+	if (!file.is_open())
+		throw failed;
+
+	auto contents = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	size = contents.size();
+
+	auto buffer = std::shared_ptr<char[]>(new (std::align_val_t {64}) char[size +1], [](char* p) { ::operator delete[](p, std::align_val_t {64}); });
+	std::memcpy(buffer.get(), contents.data(), size);
+
+	mapping = std::shared_ptr<const void>(buffer, buffer.get());
+#endif
+
+	auto const bytes = std::string_view(static_cast<char const*>(mapping.get()), size);
+
+	auto const invalid = [&](std::string const& reason)
+	{
+		return std::invalid_argument("optparse::parse: array file '" + pathname + "' of option " + field.name + " " + reason);
+	};
+
+	auto offset = size_t {0};
+	auto count = size_t {0};
+
+	if (bytes.starts_with("\x93NUMPY") && bytes.size() >= 10)
+	{
+		///	magic, version, header length (2 bytes in version 1, 4 after), then a dict such as
+		///	{'descr': '<f8', 'fortran_order': False, 'shape': (1000,), } padded with spaces
+
+		auto const wide = static_cast<unsigned char>(bytes[6]) >= 2;
+
+		auto length = size_t {0};
+
+		for (size_t i = (wide ? 4 : 2); i-- > 0; )
+			length = length << 8 | static_cast<unsigned char>(bytes[8 + i]);
+
+		offset = (wide ? 12 : 10) + length;
+
+		if (offset > bytes.size())
+			throw invalid("has a truncated .npy header");
+
+		auto const header = bytes.substr(wide ? 12 : 10, length);
+
+		auto const entry = [&header](std::string_view key)
+		{
+			auto const at = header.find(key);
+			return at == header.npos ? std::string_view {} : header.substr(header.find(':', at) +1);
+		};
+
+		auto descr = entry("'descr'");
+		descr = descr.substr(descr.find('\'') +1);
+		descr = descr.substr(0, descr.find('\''));
+
+		auto const little = std::endian::native == std::endian::little;
+
+		auto const order_ok = descr.size() > 2 && (descr[0] == '|' || descr[0] == '=' || descr[0] == (little ? '<' : '>') || field.size == 1);
+
+		if (!order_ok || descr[1] != field.kind || descr.substr(2) != std::to_string(field.size))
+			throw invalid("holds '" + std::string(descr) + "' elements, which don't match the declared type");
+
+		auto shape = entry("'shape'");
+		shape = shape.substr(shape.find('(') +1);
+		shape = shape.substr(0, shape.find(')'));
+
+		auto dimensions = size_t {0};
+
+		count = 1;
+
+		for (auto first = shape.data(), last = shape.data() + shape.size(); first < last; ++first)
+		{
+			while (first < last && (*first == ' ' || *first == ','))
+				++first;
+
+			if (first == last)
+				break;
+
+			auto extent = size_t {0};
+
+			first = std::from_chars(first, last, extent).ptr;
+
+			count *= extent;
+			++dimensions;
+		}
+
+		auto fortran = entry("'fortran_order'");
+		fortran.remove_prefix(std::min(fortran.find_first_not_of(' '), fortran.size()));
+
+		if (dimensions > 1 && fortran.starts_with("True"))
+			throw invalid("is in Fortran order, only C order is supported");
+
+		if (offset + count * field.size > bytes.size())
+			throw invalid("is shorter than its shape");
+	}
+	else
+	{
+		if (size % field.size)
+			throw invalid("has a size that isn't a multiple of the element size");
+
+		count = size / field.size;
+	}
+
+	if (field.extent && count != field.extent)
+		throw invalid("has " + std::to_string(count) + " elements, " + std::to_string(field.extent) + " were declared");
+
+	if (offset % field.size)
+		throw invalid("has its data misaligned for the element type");
+
+	auto const modified = std::filesystem::last_write_time(pathname).time_since_epoch().count();
+
+	return mapped_array {
+		.data = std::shared_ptr<const void>(mapping, bytes.data() + offset),
+		.count = count,
+		.stamp = std::to_string(size) + '@' + std::to_string(modified)
+	};
+}
+
+auto
+optparse::find_runtime_(std::string const& name) const -> size_t
+{
+	///	a handful of mutable options at most, a linear search is enough
+
+	auto field = std::find_if(runtime_fields->begin(), runtime_fields->end(), [&name](auto const& f) { return f.name == name; });
+
+	return static_cast<size_t>(field - runtime_fields->begin());
+}
+
+auto
+optparse::current_(std::string_view key, parameters const& option, std::optional<std::string_view> value) const -> std::string
+{
+	///	the text of the value in effect: the current one of a mutable option, the given one, or the default
+
+	if (option.is_mutable && !runtime.slots.empty())
+	{
+		auto const slot = find_runtime_(std::string(key));
+		auto words = seqlock_slot::words_t {};
+
+		runtime.slots[slot].load(words.data(), sizeof(words));
+
+		return (*runtime_fields)[slot].format(words.data());
+	}
+	return std::string(value ? *value : default_(option));
+}
+
+void
+optparse::store_runtime_(size_t slot, void const* value)
+{
+	auto const guard = std::lock_guard(runtime.writer);
+
+	auto const& field = (*runtime_fields)[slot];
+
+	auto previous = seqlock_slot::words_t {};
+
+	runtime.slots[slot].load(previous.data(), field.size);
+
+	runtime.slots[slot].store(value, field.size);
+
+	auto const entry = [&](void const* words)
+	{
+		auto text = field.format(words);
+
+		text.erase(std::remove_if(text.begin(), text.end(), isspace), text.end());
+
+		return hash128_(field.name, text);
+	};
+
+	auto sum = digest {};
+
+	runtime.fingerprint.load(&sum, sizeof(sum));
+
+	sum = combine_(sum, entry(previous.data()), true);
+	sum = combine_(sum, entry(value));
+
+	runtime.fingerprint.store(&sum, sizeof(sum));
+
+	/// Subscribers are notified after the value is published, in the setting thread
+
+	if (slot < runtime.subscribers.size())
+		for (auto const& notify: runtime.subscribers[slot])
+			notify(previous.data(), value);
+}
+
+template <typename T>
+void
+optparse::subscribe(mutable_option<T> option, std::function<void(T const& previous, T const& current)> callback)
+{
+	///	the callback runs with the writer lock held, it must not call set()
+
+	auto const guard = std::lock_guard(runtime.writer);
+
+	if (runtime.subscribers.size() <= option.slot)
+		runtime.subscribers.resize(option.slot + 1);
+
+	runtime.subscribers[option.slot].push_back([callback = std::move(callback)](void const* previous, void const* current)
+	{
+		auto event = change<T> {};
+
+		std::memcpy(&event.previous, previous, sizeof(T));
+		std::memcpy(&event.current, current, sizeof(T));
+
+		callback(event.previous, event.current);
+	});
+}
+
+template <typename T>
+auto
+optparse::subscribe(mutable_option<T> option, size_t capacity) -> std::shared_ptr<change_queue<T>>
+{
+	auto queue = std::make_shared<change_queue<T>>(capacity);
+
+	/// The queue is held weakly, it's no longer fed once its consumer releases it
+
+	subscribe<T>(option, [weak = std::weak_ptr(queue)](T const& previous, T const& current)
+	{
+		if (auto queue = weak.lock())
+			queue->push(change<T> { .previous = previous, .current = current });
+	});
+	return queue;
+}
+
+template <typename T>
+optparse::change_queue<T>::change_queue(size_t capacity) :
+	ring(std::bit_ceil(std::max<size_t>(capacity, 2)))
+{
+}
+
+template <typename T>
+auto
+optparse::change_queue<T>::push(change<T> const& event) -> bool
+{
+	///	a full queue drops the new event, which is counted
+
+	auto const t = tail.load(std::memory_order_relaxed);
+
+	if (t - head.load(std::memory_order_acquire) == ring.size())
+	{
+		overflow.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	ring[t & (ring.size() - 1)] = event;
+	tail.store(t + 1, std::memory_order_release);
+
+	return true;
+}
+
+template <typename T>
+auto
+optparse::change_queue<T>::pop() -> std::optional<change<T>>
+{
+	auto const h = head.load(std::memory_order_relaxed);
+
+	if (h == tail.load(std::memory_order_acquire))
+		return std::nullopt;
+
+	auto event = ring[h & (ring.size() - 1)];
+	head.store(h + 1, std::memory_order_release);
+
+	return event;
+}
+
+template <typename T>
+auto
+optparse::change_queue<T>::dropped() const -> size_t
+{
+	return overflow.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+void
+optparse::parse_(std::string_view text, void* destination)
+{
+	auto value = T {};
+
+	if (!(std::stringstream(std::string(text)) >> value))
+		throw std::runtime_error("Invalid conversion of the argument '" + std::string(text) + "' to type " + typeid(T).name());
+
+	std::memcpy(destination, &value, sizeof(T));
+}
+
+template <typename T>
+auto
+optparse::format_(void const* value) -> std::string
+{
+	auto typed = T {};
+
+	std::memcpy(&typed, value, sizeof(T));
+
+	auto text = std::ostringstream {};
+
+	text << std::setprecision(std::numeric_limits<double>::max_digits10) << typed;
+
+	return text.str();
+}
+
+void
+optparse::seqlock_slot::store(void const* source, size_t size)
+{
+	/// Called with the writer lock held
+
+	auto words = words_t {};
+
+	std::memcpy(words.data(), source, size);
+
+	auto const s = sequence.load(std::memory_order_relaxed);
+
+	sequence.store(s + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for (size_t i = 0; i < words.size(); ++i)
+		this->words[i].store(words[i], std::memory_order_relaxed);
+
+	sequence.store(s + 2, std::memory_order_release);
+}
+
+void
+optparse::seqlock_slot::load(void* destination, size_t size) const
+{
+	auto words = words_t {};
+
+	for (;;)
+	{
+		auto const s = sequence.load(std::memory_order_acquire);
+
+		for (size_t i = 0; i < words.size(); ++i)
+			words[i] = this->words[i].load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (!(s & 1) && sequence.load(std::memory_order_relaxed) == s)
+			break;
+	}
+	std::memcpy(destination, words.data(), size);
+}
+
+optparse::runtime_state::runtime_state(runtime_state const& other)
+{
+	*this = other;
+}
+
+auto
+optparse::runtime_state::operator=(runtime_state const& other) -> runtime_state&
+{
+	///	copies hold the current values in slots of their own
+
+	if (this == &other)
+		return *this;
+
+	auto const guard = std::scoped_lock(writer);
+
+	slots.clear();
+
+	for (auto const& slot: other.slots)
+	{
+		auto words = seqlock_slot::words_t {};
+
+		slot.load(words.data(), sizeof(words));
+		slots.emplace_back().store(words.data(), sizeof(words));
+	}
+
+	auto words = seqlock_slot::words_t {};
+
+	other.fingerprint.load(words.data(), sizeof(digest));
+	fingerprint.store(words.data(), sizeof(digest));
+
+	return *this;
+}
+
+auto
+optparse::load(std::string pathname) const -> std::map<std::string, std::string>
+{
+	///	pathname may list several fragments separated by commas, all of them read in one batch
+
+	auto paths = std::vector<std::string> {};
+
+	auto standard_input = false;
+
+	for (size_t begin = 0, end; begin <= pathname.size(); begin = end +1)
+	{
+		end = std::min(pathname.find(',', begin), pathname.size());
+
+		if (pathname.compare(begin, end - begin, "-") == 0)
+			standard_input = true;
+
+		else if (end > begin)
+			paths.push_back(pathname.substr(begin, end - begin));
+	}
+
+	auto values = std::map<std::string, std::string> {};
+
+	for (auto const& buffer: read_files_(paths))
+		tokenize_(buffer, values);
+
+	if (standard_input)
+		tokenize_(read_descriptor_(0), values);
+
+	return values;
+}
+
+auto
+optparse::load(config_source const& source) const -> std::map<std::string, std::string>
+{
+	if (source.kind == config_source::kind_t::file)
+		return load(source.pathname);
+
+	auto values = std::map<std::string, std::string> {};
+
+	if (source.kind == config_source::kind_t::buffer)
+		tokenize_(source.text, values);
+	else
+		tokenize_(read_descriptor_(source.fd), values);
+
+	return values;
+}
+
+auto
+optparse::read_descriptor_(int fd) -> std::string
+{
+	auto text = std::string {};
+
+#ifdef OPTPARSE_POSIX
+	char chunk[65536];
+
+	for (ssize_t bytes; (bytes = ::read(fd, chunk, sizeof(chunk))) != 0; )
+	{
+		if (bytes < 0 && errno == EINTR)
+			continue;
+
+		if (bytes < 0)
+			throw std::runtime_error("optparse::parse: reading from descriptor " + std::to_string(fd) + " failed: " + std::strerror(errno));
+
+		text.append(chunk, bytes);
+	}
+#else
+	if (fd != 0)
+		throw std::logic_error("optparse::parse: descriptors other than the standard input are only supported on POSIX systems");
+
+	text.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+#endif
+	return text;
+}
+
+auto
+optparse::config_source::file(std::string pathname) -> config_source
+{
+	auto source = config_source(kind_t::file);
+	source.pathname = pathname;
+	return source;
+}
+
+auto
+optparse::config_source::descriptor(int fd) -> config_source
+{
+	auto source = config_source(kind_t::descriptor);
+	source.fd = fd;
+	return source;
+}
+
+auto
+optparse::config_source::buffer(std::string_view text) -> config_source
+{
+	///	text must outlive the parse() or layer() call using it, not the values read from it
+
+	auto source = config_source(kind_t::buffer);
+	source.text = text;
+	return source;
+}
+
+auto
+optparse::config_source::standard_input() -> config_source
+{
+	return descriptor(0);
+}
+
+auto
+optparse::config_sink::file(std::string pathname) -> config_sink
+{
+	auto sink = config_sink(kind_t::file);
+	sink.pathname = pathname;
+	return sink;
+}
 
-	typedef struct {
-		size_t nargs;
-		std::string default_value;
-		std::string	description;
-		bool user_option;
-	} parameters;
+auto
+optparse::config_sink::descriptor(int fd) -> config_sink
+{
+	auto sink = config_sink(kind_t::descriptor);
+	sink.fd = fd;
+	return sink;
+}
 
-	/// variables
+auto
+optparse::config_sink::buffer(std::string& text) -> config_sink
+{
+	auto sink = config_sink(kind_t::buffer);
+	sink.text = &text;
+	return sink;
+}
 
-	std::string program_name;
+void
+optparse::tokenize_(std::string_view buffer, std::map<std::string, std::string>& values) const
+{
+	///	Buffers of several MiB are cut at line boundaries into one chunk per thread, each read into
+	///	a map of its own. The maps are spliced together afterwards, and whatever a merge leaves
+	///	behind in a chunk is a key that was seen before.
 
-	std::map<std::string, parameters> options;
-	std::map<std::string, std::string> values;
+	if (buffer.size() < (size_t {2} << 22))	// no need to ask for the cores, a query costs microseconds
+		return tokenize_lines_(buffer, values);
 
-public:
+	auto const threads = std::min<size_t>(std::thread::hardware_concurrency(), buffer.size() / (size_t {1} << 22));
 
-	enum action_t { store_true = 0, store_false = 1 };
+	if (threads < 2)
+		return tokenize_lines_(buffer, values);
 
-	optparse(); /// Constructor
+	auto chunks = std::vector<std::string_view> {};
 
-	void insert_option(std::string name, size_t nargs = 1, std::string description = "", std::string default_value = "");
+	for (size_t begin = 0, end; begin < buffer.size(); begin = end +1)
+	{
+		end = std::min(buffer.find('\n', std::min(begin + buffer.size() / threads, buffer.size())), buffer.size());
 
-	void insert_option_boolean(std::string name, action_t action, std::string description = "");
+		chunks.push_back(buffer.substr(begin, end - begin));
+	}
 
-	auto parse(const int argc, char* const* const argv) -> int;
+	auto partial = std::vector<std::map<std::string, std::string>>(chunks.size());
+	auto errors = std::vector<std::exception_ptr>(chunks.size());
 
-	template <typename T, size_t n=0>
-	T
-	retrieve(std::string name) const;
+	auto worker = [&](size_t i)
+	{
+		try
+		{
+			tokenize_lines_(chunks[i], partial[i]);
+		}
+		catch (...)
+		{
+			errors[i] = std::current_exception();
+		}
+	};
 
-	template <typename T, typename U>
-	std::pair<T, U>
-	retrieve(std::string name) const;
+	auto pool = std::vector<std::thread> {};
 
-	auto dump(std::string pathname) const;
+	for (size_t i = 1; i < chunks.size(); ++i)
+		pool.emplace_back(worker, i);
 
-private:
+	worker(0);
 
-	void insert_option_impl_(std::string name, parameters const& p);
+	for (auto& thread: pool)
+		thread.join();
 
-	auto load(std::string pathname) -> std::map<std::string, std::string>;
+	for (auto const& error: errors)	// the first one in file order, as a sequential read would have thrown
+		if (error)
+			std::rethrow_exception(error);
 
-	auto usage(std::string error_message = "") const -> int;
-};
+	for (auto& chunk: partial)
+	{
+		values.merge(chunk);
 
-optparse::optparse()
-{
-	insert_option_impl_("help", ((parameters){ .nargs = 0, .description = "Print this message", .user_option = false }));
-	insert_option_impl_("load", ((parameters){ .nargs = 1, .description = "Load settings from configuration file", .user_option = false }));
+		if (!chunk.empty())
+			throw std::runtime_error("optparse::parse: duplicate option found in the configuration file: " + chunk.begin()->first);
+	}
 }
 
 void
-optparse::insert_option(std::string name, size_t nargs, std::string description, std::string default_value)
+optparse::tokenize_lines_(std::string_view buffer, std::map<std::string, std::string>& values) const
 {
-	auto option_parameters = parameters {
-		.nargs = nargs,
-		.default_value = default_value,
-		.description = description,
-		.user_option = true
-	};
+	for (size_t begin = 0, end; begin < buffer.size(); begin = end +1)
+	{
+		end = std::min(buffer.find('\n', begin), buffer.size());
 
-	insert_option_impl_(name, option_parameters);
-}
+		auto line = std::string {};
 
-void
-optparse::insert_option_boolean(std::string name, action_t action, std::string description)
-{
-	insert_option(name, 0, description, (action == store_true) ? "0" : "1");
+		for (auto c: buffer.substr(begin, end - begin))
+			if (!isspace(static_cast<unsigned char>(c)))
+				line += c;
+
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		auto delimiterPos = line.find(":");
+
+		auto key = line.substr(0, delimiterPos);
+		auto value = line.substr(delimiterPos +1);
+
+		if (!find_option_(key))
+			throw std::runtime_error("optparse::parse: read an unexpected option from the configuration file: " + key + did_you_mean_(key));
+
+		if (const auto &[it, inserted] = values.try_emplace(key, value); !inserted)
+			throw std::runtime_error("optparse::parse: duplicate option found in the configuration file: " + key);
+	}
 }
 
 auto
-optparse::parse(const int argc, char* const* const argv) -> int
+optparse::read_files_(std::vector<std::string> const& paths) -> std::vector<std::string>
 {
-	auto ierr = int {0};
+	///	io_uring when the kernel allows it, otherwise a pool of threads reading one file each.
+	///	A single file is read in place: setting up a ring costs more than it saves
 
-	program_name = std::string(argv[0]);
+#ifdef OPTPARSE_IO_URING
+	if (paths.size() > 1)
+		if (auto buffers = read_files_uring_(paths))
+			return std::move(*buffers);
+#endif
 
-	/// Try to process all the arguments
+	auto buffers = std::vector<std::string>(paths.size());
+	auto failed = std::vector<char>(paths.size(), false);
 
-	try
-	{
-		/// Loop over argv[], ignoring the first argument
+	auto next = std::atomic<size_t> {0};
 
-		for (int i = 1; i < argc; ++i)
+	auto worker = [&]()
+	{
+		for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < paths.size(); )
 		{
-			auto idx = strspn(argv[i], "-");
+#ifdef OPTPARSE_POSIX
+			auto fd = ::open(paths[i].c_str(), O_RDONLY | O_CLOEXEC);
 
-			auto key = std::string(&argv[i][idx]);
+			struct stat status;
 
-			if (!idx)
-				throw std::invalid_argument("optparse::parse: argument options must start with a single/double dash"); // invalid argument
+			if (fd < 0 || ::fstat(fd, &status) != 0)
+				failed[i] = true;
 
-			if (!key.compare("help"))
+			else
 			{
-				ierr = usage();
-				break;
-			}
+				buffers[i].resize(status.st_size);
 
-			//~ there's an argument option and it isn't --help
+				for (size_t offset = 0; offset < buffers[i].size(); )
+				{
+					auto bytes = ::pread(fd, buffers[i].data() + offset, buffers[i].size() - offset, offset);
 
-			if (auto option = options.find(key); option == options.end())
-				throw std::invalid_argument("optparse::parse: unknow argument: " + key);
+					if (bytes < 0 && errno == EINTR)
+						continue;
+
+					if (bytes <= 0)
+					{
+						buffers[i].resize(offset);
+						failed[i] = bytes < 0;
+						break;
+					}
+					offset += bytes;
+				}
+			}
+			if (fd >= 0)
+				::close(fd);
+#else
+			std::ifstream config(paths[i], std::ios::binary);
 
+			if (!config.is_open())
+				failed[i] = true;
 			else
-			{
-				auto value = std::string {};
+				buffers[i].assign(std::istreambuf_iterator<char>(config), std::istreambuf_iterator<char>());
+#endif
+		}
+	};
 
-				if (option->second.nargs == 0)
-					value = std::to_string(option->second.default_value.compare("0") == 0);	// invert bool "0" -> 1
+	auto const threads = std::min<size_t>({ paths.size(), std::max(1u, std::thread::hardware_concurrency()), 16 });
 
-				else if (argc - i < (int) option->second.nargs +1)
-					throw std::runtime_error("optparse::parse: insufficient number of argument values");
+	auto pool = std::vector<std::thread>(threads > 1 ? threads -1 : 0);	// the calling thread is the last worker
 
-				else // ok, there's enough argument values, process all of them
-				{
-					value = std::string(argv[++i]);
+	for (auto& thread: pool)
+		thread = std::thread(worker);
 
-					for (int j = 1; j < (int) option->second.nargs; ++j)
-						value += ", " + std::string(argv[++i]);
-				}
+	worker();
 
-				if (const auto &[it, inserted] = values.try_emplace(key, value); !inserted)
-					throw std::runtime_error("optparse::parse: duplicate option passed by command line: " + key);
-			}
-		}
+	for (auto& thread: pool)
+		thread.join();
 
-		if (ierr == 0x00)
-		{
-			/// Read and transfer option values from the configuration file
+	for (size_t i = 0; i < paths.size(); ++i)
+		if (failed[i])
+			throw std::runtime_error("optparse::parse: opening file '" + paths[i] + \
+					"' failed, it either doesn't exist or is not accessible.");
 
-			if (auto value = values.find("load"); value != values.end())
-			{
-				values.merge(load(value->second));
-				values.erase("load");
-			}
+	return buffers;
+}
 
-			/// Post processing -- check for every option besides load and help
+#ifdef OPTPARSE_IO_URING
 
-			for (auto const& option: options)
-			{
-				if (!option.first.compare("load") || !option.first.compare("help"))
-					continue;
+auto
+optparse::read_files_uring_(std::vector<std::string> const& paths) -> std::optional<std::vector<std::string>>
+{
+	///	Three batches through a single ring: openat + statx of every path, then one read per file,
+	///	then the closes. Returns nothing when io_uring can't be used, so that the caller falls back.
 
-				if (auto value = values.find(option.first); value == values.end() && !option.second.default_value.length())
-					throw std::invalid_argument("optparse::parse: missing argument(s), e.g., " + option.first);
-			}
-		}
-	}
-	catch (const std::exception& e)
+	auto params = io_uring_params {};
+
+	auto const entries = std::bit_ceil(std::clamp<unsigned>(2 * paths.size(), 1, 256));
+
+	auto ring = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+
+	if (ring < 0)
+		return std::nullopt;
+
+	auto const sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	auto const cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	auto const single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+	auto sq = ::mmap(nullptr, single ? std::max(sq_size, cq_size) : sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+	auto cq = single ? sq : ::mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+	auto sqes = ::mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+
+	auto release = [&]()
 	{
-		ierr = usage(e.what());
+		if (sqes != MAP_FAILED) ::munmap(sqes, params.sq_entries * sizeof(io_uring_sqe));
+		if (cq != MAP_FAILED && !single) ::munmap(cq, cq_size);
+		if (sq != MAP_FAILED) ::munmap(sq, single ? std::max(sq_size, cq_size) : sq_size);
+		::close(ring);
+	};
+
+	if (sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED)
+	{
+		release();
+		return std::nullopt;
 	}
-	return ierr;
-}
 
-template <typename T, size_t n = 0>
-T
-optparse::retrieve(std::string name) const
-{
-	auto value = T {};
+	auto word = [](void* base, unsigned offset) { return reinterpret_cast<unsigned*>(static_cast<char*>(base) + offset); };
 
-	/// Lambda function to split the option values' string
+	auto sq_tail = word(sq, params.sq_off.tail);
+	auto sq_array = word(sq, params.sq_off.array);
+	auto const sq_mask = *word(sq, params.sq_off.ring_mask);
+
+	auto cq_head = word(cq, params.cq_off.head);
+	auto cq_tail = word(cq, params.cq_off.tail);
+	auto const cq_mask = *word(cq, params.cq_off.ring_mask);
+	auto cqes = reinterpret_cast<io_uring_cqe*>(static_cast<char*>(cq) + params.cq_off.cqes);
 
-	static auto const split = [](std::string s, int pos)
+	///	submits count operations, at most a ring at a time, and returns the result of each, or
+	///	unsubmitted for the ones the kernel never took (taken: no completion yet) when io_uring_enter
+	///	failed. The ring is broken from then on, and left alone.
+
+	auto constexpr unsubmitted = std::numeric_limits<int>::min();
+	auto constexpr taken = unsubmitted + 1;
+
+	auto broken = false;
+
+	auto batch = [&](size_t count, auto&& prepare) -> std::vector<int>
 	{
-		auto [start, end] = std::pair(0U, s.find(","));
+		auto results = std::vector<int>(count, unsubmitted);
 
-		for (int i = 0; end != std::string::npos; ++i)
-	   	{
-			if (i == pos)
-				return s.substr(start, end - start);
+		for (size_t first = 0; first < count && !broken; first += params.sq_entries)
+		{
+			auto const size = std::min<size_t>(count - first, params.sq_entries);
 
-			start = end + 1;
-   		    end = s.find(",", start);
-	   	}
-		return s.substr(start, end);
+			auto tail = *sq_tail;
+
+			for (size_t i = first; i < first + size; ++i, ++tail)
+			{
+				auto& sqe = static_cast<io_uring_sqe*>(sqes)[tail & sq_mask];
+
+				sqe = io_uring_sqe {};
+				sqe.user_data = i;
+				prepare(i, sqe);
+
+				sq_array[tail & sq_mask] = tail & sq_mask;
+			}
+			std::atomic_ref(*sq_tail).store(tail, std::memory_order_release);
+
+			for (size_t submitted = 0, completed = 0; completed < size; )
+			{
+				auto const entered = ::syscall(__NR_io_uring_enter, ring, size - submitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+
+				if (entered < 0 && errno != EINTR)
+				{
+					broken = true;
+					break;
+				}
+
+				for (auto end = submitted + std::max<long>(entered, 0); submitted < end; ++submitted)
+					results[first + submitted] = taken;
+
+				auto head = *cq_head;
+
+				for (; head != std::atomic_ref(*cq_tail).load(std::memory_order_acquire); ++head, ++completed)
+					results[cqes[head & cq_mask].user_data] = cqes[head & cq_mask].res;
+
+				std::atomic_ref(*cq_head).store(head, std::memory_order_release);
+			}
+		}
+		return results;
 	};
 
-	/// Search the name in the options
+	auto status = std::vector<struct statx>(paths.size());
 
-	if (auto option = values.find(name); option != values.end())
+	auto opened = batch(2 * paths.size(), [&](size_t i, io_uring_sqe& sqe)
 	{
-		auto argument = split(option->second, n);
+		sqe.fd = AT_FDCWD;
+		sqe.addr = reinterpret_cast<uintptr_t>(paths[i / 2].c_str());
 
-		if (!(std::stringstream(argument) >> value))
-			throw std::runtime_error("Invalid conversion of the argument '" + argument + "' to type " + typeid(T).name());
-	}
-	else if (auto option = options.find(name); option != options.end() && option->second.default_value.length())
+		if (i % 2 == 0)
+		{
+			sqe.opcode = IORING_OP_OPENAT;
+			sqe.open_flags = O_RDONLY | O_CLOEXEC;
+		}
+		else
+		{
+			sqe.opcode = IORING_OP_STATX;
+			sqe.len = STATX_SIZE;
+			sqe.off = reinterpret_cast<uintptr_t>(&status[i / 2]);
+		}
+	});
+
+	auto buffers = std::vector<std::string>(paths.size());
+
+	auto read = std::vector<int> {};
+
+	auto const supported = !broken && std::none_of(opened.begin(), opened.end(), [](int result) { return result == -EINVAL || result == -EOPNOTSUPP; });
+
+	if (supported)
 	{
-		auto argument = option->second.nargs == 0 ?
-			std::to_string(option->second.default_value.compare("0") != 0) :
-			split(option->second.default_value, n);
+		for (size_t i = 0; i < paths.size(); ++i)
+			if (opened[2*i] >= 0 && opened[2*i +1] >= 0)
+				buffers[i].resize(status[i].stx_size);
 
-		if (!(std::stringstream(argument) >> value))
-			throw std::runtime_error("Invalid conversion of the argument '" + argument + "' to type " + typeid(T).name());
+		read = batch(paths.size(), [&](size_t i, io_uring_sqe& sqe)
+		{
+			sqe.opcode = opened[2*i] >= 0 ? IORING_OP_READ : IORING_OP_NOP;
+			sqe.fd = opened[2*i];
+			sqe.addr = reinterpret_cast<uintptr_t>(buffers[i].data());
+			sqe.len = buffers[i].size();
+		});
 	}
-	else
-		throw std::invalid_argument("optparse::retrieve no argument has been passed to option: " + name);
-
-	return value;
-}
 
-template <typename T, typename U>
-std::pair<T, U>
-optparse::retrieve(std::string name) const
-{
-	return std::pair(retrieve<T, 0>(name), retrieve<U, 1>(name));
-}
+	auto descriptors = std::vector<int> {};
 
-auto
-optparse::dump(std::string pathname) const
-{
-	std::ofstream config(pathname, std::ios::app);
+	for (size_t i = 0; i < opened.size(); i += 2)
+		if (opened[i] >= 0)
+			descriptors.push_back(opened[i]);
 
-	if (!config.is_open())
-		throw std::runtime_error("optparse::parse: opening file '" + pathname + \
-				"' failed, it either doesn't exist or is not accessible.");
+	///	the descriptors the kernel didn't take are closed here, the others may be closed already
+	///	and their numbers reused by another thread
 
-	std::time_t result = std::time(nullptr);
+	auto const closed = batch(descriptors.size(), [&](size_t i, io_uring_sqe& sqe) { sqe.opcode = IORING_OP_CLOSE; sqe.fd = descriptors[i]; });
 
-	char mbstr[100];
+	for (size_t i = 0; i < descriptors.size(); ++i)
+		if (closed[i] == unsubmitted)
+			::close(descriptors[i]);
 
-	///	writes standard date and time string, e.g. Sun Oct 17 04:41:13 2010 (locale dependent)
+	release();
 
-	if (std::strftime(mbstr, sizeof(mbstr), "%c", std::localtime(&result)))
-	{
-		config << "\n# Created automaticaly by optparse on " << std::string(mbstr) << '\n' << std::endl;
-    }
-	else
-		config << "\n# Created automaticaly by optparse" << '\n' << std::endl;
+	if (!supported || broken)
+		return std::nullopt;
 
-	for (auto const& option: this->options)
+	for (size_t i = 0; i < paths.size(); ++i)
 	{
-		auto key = option.first;
-
-		if (auto value = values.find(key); value != values.end())
-			config << key << ": " << value->second << '\n';
+		if (opened[2*i] < 0 || opened[2*i +1] < 0 || read[i] < 0)
+			throw std::runtime_error("optparse::parse: opening file '" + paths[i] + \
+					"' failed, it either doesn't exist or is not accessible.");
 
-		else if (auto default_value = option.second.default_value; option.second.user_option)
-			config << key << ": " << default_value << '\n';
+		if (static_cast<size_t>(read[i]) < buffers[i].size())
+			return std::nullopt;	// a short read, let the pread loop deal with it
 	}
-	config << std::endl;
-	config.close();
+	return buffers;
 }
 
-// private methods
+#endif
 
-void
-optparse::insert_option_impl_(std::string name, parameters const& p)
+auto
+optparse::did_you_mean_(std::string const& name) const -> std::string
 {
+	auto hint = std::string {};
 
-	if (const auto &[it, inserted] = options.try_emplace(name, p); !inserted)
-		throw std::invalid_argument("optparse::insert_option: option already exists: " + name);
-}
+	for (auto const& suggestion: suggest(name))
+		hint += (hint.empty() ? " (did you mean --" : ", --") + suggestion;
 
+	return hint.empty() ? hint : hint + "?)";
+}
 
 auto
-optparse::load(std::string pathname) -> std::map<std::string, std::string>
+optparse::edit_distance_(uint64_t const (&peq)[256], size_t m, std::string_view text) -> size_t
 {
-	auto values = std::map<std::string, std::string> {};
-
-	std::ifstream config(pathname);
+	///	Levenshtein distance between the (m <= 64) pattern encoded in peq and text,
+	///	one column of the dynamic programming matrix per character as bit-vectors
 
-	if (!config.is_open())
-		throw std::runtime_error("optparse::parse: opening file '" + pathname + \
-				"' failed, it either doesn't exist or is not accessible.");
+	auto [pv, mv] = std::pair(~uint64_t {0}, uint64_t {0});
 
-	for (std::string line; std::getline(config, line); )
-	{
-		line.erase(std::remove_if(line.begin(), line.end(), isspace), line.end());
+	auto const last = uint64_t {1} << (m - 1);
 
-		if (line[0] == '#' || line.empty())
-			continue;
+	auto score = m;
 
-		auto delimiterPos = line.find(":");
+	for (unsigned char c: text)
+	{
+		auto const eq = peq[c];
+		auto const xv = eq | mv;
+		auto const xh = (((eq & pv) + pv) ^ pv) | eq;
 
-		auto key = line.substr(0, delimiterPos);
-		auto value = line.substr(delimiterPos +1);
+		auto ph = mv | ~(xh | pv);
+		auto mh = pv & xh;
 
-		if (auto option = options.find(key); option == options.end())
-			throw std::runtime_error("optparse::parse: read an unexpected option from the configuration file: " + key);
+		if (ph & last)
+			++score;
+		else if (mh & last)
+			--score;
 
-		if (const auto &[it, inserted] = values.try_emplace(key, value); !inserted)
-			throw std::runtime_error("optparse::parse: duplicate option found in the configuration file: " + key);
+		ph = (ph << 1) | 1;
+		mh = (mh << 1);
 
+		pv = mh | ~(xv | ph);
+		mv = ph & xv;
 	}
-	config.close();
-
-	return values;
+	return score;
 }
 
 auto
-optparse::usage(std::string error_message) const -> int
+optparse::usage(std::string error_message, std::string term) const -> int
 {
-	std::clog << "Usage: " << program_name << " [OPTIONS]\n\nWhere OPTIONS are:\n";
+	///	the whole message is formatted in memory and written at once
+
+	auto text = std::ostringstream {};
+
+	text << "Usage: " << program_name << " [OPTIONS]\n\nWhere OPTIONS are:\n";
+
+	auto const matches = term.length() ? search_(term) : std::vector<std::string_view> {};
+
+	if (term.length() && matches.empty())
+		text << std::right << std::setw(16) << " " << "no option matches '" << term << "'\n";
 
 	//! user options are defined externally, as opposed to pre-defined options.
 	//	show user options LAST
 
 	for (int user_option = 0; user_option < 2; ++user_option)
 	{
-		for (auto const& option: options)
+		for_each_option_([&](std::string_view key, parameters const& option, std::optional<std::string_view>)
 		{
-			if (static_cast<int>(option.second.user_option)^user_option)
-				continue;
+			if (static_cast<int>(option.user_option)^user_option)
+				return;
 
-			std::clog << std::right << std::setw(16) << "--" + option.first;
+			if (term.length() && !std::binary_search(matches.begin(), matches.end(), key))
+				return;
 
-			for (int index = 0; index < (int) option.second.nargs; ++index)
-				std::clog << " <arg>";
+			text << std::right << std::setw(16) << "--" + std::string(key);
 
-			std::clog << std::right << std::setw(18 - 6 * option.second.nargs) << " ";
-			std::clog << (option.second.description.length() ? option.second.description : "*** description unavailable ***") << '\n';
-		}
+			for (int index = 0; index < (int) option.nargs; ++index)
+				text << " <arg>";
+
+			text << std::right << std::setw(18 - 6 * option.nargs) << " ";
+			text << (description_(option).length() ? description_(option) : "*** description unavailable ***") << '\n';
+		});
 	}
-	std::clog << std::endl;
+	std::clog << text.str() << std::endl;
 
 	if (error_message.length())
 	{
@@ -343,4 +4456,70 @@ optparse::usage(std::string error_message) const -> int
 		return 1;
 }
 
+auto
+optparse::search_(std::string const& term) const -> std::vector<std::string_view>
+{
+	///	lowercase alphanumeric words, so 'cutoff_radius' is found by 'cutoff' and 'radius'
+
+	static auto const tokenize = [](std::string_view text)
+	{
+		auto tokens = std::vector<std::string> {1};
+
+		for (unsigned char c: text)
+		{
+			if (std::isalnum(c))
+				tokens.back() += static_cast<char>(std::tolower(c));
+
+			else if (!tokens.back().empty())
+				tokens.emplace_back();
+		}
+		if (tokens.back().empty())
+			tokens.pop_back();
+
+		return tokens;
+	};
+
+	/// The inverted index (word -> sorted option names) is built on the first search
+
+	if (!help_index)
+	{
+		auto index = std::make_shared<std::map<std::string, std::vector<std::string_view>>>();
+
+		for_each_option_([this, &index](std::string_view key, parameters const& option, std::optional<std::string_view>)
+		{
+			for (auto const& token: tokenize(std::string(key) + ' ' + std::string(description_(option))))
+				if (auto& postings = (*index)[token]; postings.empty() || postings.back() != key)
+					postings.push_back(key);
+		});
+		help_index = index;
+	}
+
+	/// Each word of the term matches every indexed word it prefixes, the matches of all
+	///	the term words are intersected
+
+	auto matches = std::vector<std::string_view> {};
+
+	auto const words = tokenize(term);
+
+	for (auto word = words.begin(); word != words.end(); ++word)
+	{
+		auto found = std::vector<std::string_view> {};
+
+		for (auto it = help_index->lower_bound(*word); it != help_index->end() && it->first.starts_with(*word); ++it)
+			found.insert(found.end(), it->second.begin(), it->second.end());
+
+		std::sort(found.begin(), found.end());
+		found.erase(std::unique(found.begin(), found.end()), found.end());
+
+		if (word != words.begin())
+		{
+			auto both = std::vector<std::string_view> {};
+			std::set_intersection(matches.begin(), matches.end(), found.begin(), found.end(), std::back_inserter(both));
+			found.swap(both);
+		}
+		matches.swap(found);
+	}
+	return matches;
+}
+
 #endif